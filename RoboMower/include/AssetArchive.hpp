@@ -0,0 +1,108 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+//read only view of an asset archive made by robomower-packer. The file
+//is memory mapped, so assets can be loaded straight from it with the
+//SFML loadFromMemory() functions without copying or opening more files.
+//
+//layout, all integers little endian:
+//  header: "RMPK", u32 version, u32 entry count, u32 index size
+//  index:  per entry u16 path length, path, u8 flags, u64 offset,
+//          u64 stored size, u64 size
+//  blobs:  each starting on an Alignment boundary
+
+#ifndef RM_ASSET_ARCHIVE_HPP_
+#define RM_ASSET_ARCHIVE_HPP_
+
+#include <SFML/Config.hpp>
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+class AssetArchive final
+{
+public:
+    static const sf::Uint32 Version = 1;
+    static const std::size_t HeaderSize = 16;
+    static const std::size_t Alignment = 16;
+
+    enum Flags
+    {
+        Compressed = 0x1 //LZ4 block, only readable if built with RM_USE_LZ4
+    };
+
+    struct View final
+    {
+        const char* data = nullptr;
+        std::size_t size = 0;
+        bool valid() const { return data != nullptr; }
+    };
+
+    AssetArchive();
+    ~AssetArchive();
+    AssetArchive(const AssetArchive&) = delete;
+    AssetArchive& operator = (const AssetArchive&) = delete;
+
+    //returns false if the file is missing or isn't a valid archive
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+
+    bool contains(const std::string& path) const;
+    /*!
+    \brief Returns a view of the asset stored with the given path, or an
+    invalid view if it's not in the archive. Uncompressed assets point into
+    the mapped file, compressed ones are expanded into buffer. Safe to call
+    from several threads at once, as long as each has its own buffer.
+    */
+    View read(const std::string& path, std::vector<char>& buffer) const;
+
+    static bool compressionAvailable();
+
+private:
+    struct Entry final
+    {
+        sf::Uint64 offset = 0;
+        sf::Uint64 storedSize = 0;
+        sf::Uint64 size = 0;
+        sf::Uint8 flags = 0;
+    };
+    std::unordered_map<std::string, Entry> m_entries;
+
+    const char* m_data;
+    std::size_t m_size;
+    //platform handles, kept opaque so the header doesn't need the OS includes
+    void* m_file;
+    void* m_mapping;
+
+    bool readIndex();
+};
+
+#endif //RM_ASSET_ARCHIVE_HPP_
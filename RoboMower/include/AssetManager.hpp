@@ -0,0 +1,217 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+//process wide cache of the assets listed in assets/manifest.json. Each
+//asset is loaded and parsed the first time it's asked for, then kept
+//while anything holds a lease on it. Assets nobody is using stay around
+//too, so returning to a menu or the game doesn't touch the disk, and are
+//only evicted, least recently used first, when the cache is over budget.
+//Groups of assets listed in the manifest can be prefetched, which reads
+//and decodes them on worker threads while the caller gets on with other
+//things. Only the upload to the GPU is left for the thread using them.
+//If an archive made by robomower-packer is given, assets are read from
+//it, and only looked for as loose files if it's missing or lacks them
+
+#ifndef RM_ASSET_MANAGER_HPP_
+#define RM_ASSET_MANAGER_HPP_
+
+#include <AssetArchive.hpp>
+
+#include <xygine/Resource.hpp>
+#include <xygine/components/ParticleSystem.hpp>
+
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/Font.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+//named positions of sub-images in a tile set texture, read from a .tst file
+struct TileSet final
+{
+    std::unordered_map<std::string, sf::Vector2f> positions;
+
+    //returns a zero vector for missing names, as the old parsers did
+    sf::Vector2f get(const std::string& name) const
+    {
+        auto result = positions.find(name);
+        return (result == positions.end()) ? sf::Vector2f() : result->second;
+    }
+};
+
+class AssetManager final
+{
+private:
+    template <typename T>
+    struct Entry final
+    {
+        std::string path;
+        std::unique_ptr<T> asset;
+        //fonts keep reading from the memory they're loaded from
+        std::vector<char> memory;
+        bool loaded = false; //also true if loading failed, so it isn't retried
+        std::size_t refCount = 0;
+        std::size_t size = 0;
+        sf::Uint64 lastUsed = 0;
+    };
+
+public:
+    static const std::size_t DefaultBudget = 64 * 1024 * 1024;
+
+    explicit AssetManager(const std::string& manifestPath, const std::string& archivePath = "");
+    ~AssetManager() = default;
+    AssetManager(const AssetManager&) = delete;
+    AssetManager& operator = (const AssetManager&) = delete;
+
+    /*!
+    \brief Holds a reference on each asset fetched through it, which is
+    released when the lease is destroyed. Returned references stay valid
+    for the lifetime of the lease. Requests for IDs missing from the
+    manifest, or which fail to load, return a fallback asset
+    */
+    class Lease final
+    {
+    public:
+        explicit Lease(AssetManager&);
+        //prefetches the named group from the manifest
+        Lease(AssetManager&, const std::string& group);
+        ~Lease();
+        Lease(const Lease&) = delete;
+        Lease& operator = (const Lease&) = delete;
+
+        sf::Texture& getTexture(const std::string& id);
+        sf::Font& getFont(const std::string& id);
+        const TileSet& getTileSet(const std::string& id);
+        const xy::ParticleSystem::Definition& getParticles(const std::string& id);
+
+    private:
+        AssetManager& m_manager;
+        std::vector<std::size_t*> m_refCounts;
+
+        template <typename T>
+        void acquire(Entry<T>&);
+    };
+
+    //starts decoding every asset in a manifest group which isn't already
+    //loaded. Fetching one waits for it to finish if it's still in progress
+    void prefetch(const std::string& group);
+
+    //the size unused assets are allowed to grow to before being evicted
+    void setBudget(std::size_t bytes);
+    std::size_t getResidentSize() const { return m_residentSize; }
+    //drops every asset which isn't currently leased
+    void evictUnused();
+
+private:
+    std::unordered_map<std::string, Entry<sf::Texture>> m_textures;
+    std::unordered_map<std::string, Entry<sf::Font>> m_fonts;
+    std::unordered_map<std::string, Entry<TileSet>> m_tileSets;
+    std::unordered_map<std::string, Entry<xy::ParticleSystem::Definition>> m_particles;
+
+    //particle definitions load their own textures, which needs the
+    //GPU, so they aren't decoded in the background
+    struct Group final
+    {
+        std::vector<std::string> textures;
+        std::vector<std::string> fonts;
+        std::vector<std::string> tileSets;
+    };
+    std::unordered_map<std::string, Group> m_groups;
+
+    //must outlive the decoding tasks, which may be reading from it
+    AssetArchive m_archive;
+
+    //data points either into the archive or at buffer
+    struct FileData final
+    {
+        std::vector<char> buffer;
+        const char* data = nullptr;
+        std::size_t size = 0;
+    };
+
+    template <typename T>
+    struct Decoded final
+    {
+        std::unique_ptr<T> asset;
+        std::string error;
+    };
+    std::unordered_map<std::string, std::future<Decoded<sf::Image>>> m_pendingImages;
+    std::unordered_map<std::string, std::future<Decoded<FileData>>> m_pendingFonts;
+    std::unordered_map<std::string, std::future<Decoded<TileSet>>> m_pendingTileSets;
+
+    std::size_t m_budget;
+    std::size_t m_residentSize;
+    sf::Uint64 m_useCounter;
+
+    //fallbacks, and the textures particle definitions point to
+    xy::TextureResource m_textureResource;
+    xy::FontResource m_fontResource;
+    std::unique_ptr<sf::Texture> m_fallbackTexture;
+    sf::Font* m_fallbackFont;
+    TileSet m_fallbackTileSet;
+    xy::ParticleSystem::Definition m_fallbackParticles;
+
+    void loadManifest(const std::string&);
+    bool readAsset(const std::string& path, FileData&) const;
+
+    Entry<sf::Texture>& getTextureEntry(const std::string&);
+    Entry<sf::Font>& getFontEntry(const std::string&);
+    Entry<TileSet>& getTileSetEntry(const std::string&);
+    Entry<xy::ParticleSystem::Definition>& getParticleEntry(const std::string&);
+
+    //these run on worker threads, so only touch what they're given and the archive
+    Decoded<sf::Image> decodeImage(const std::string& path) const;
+    Decoded<FileData> readFont(const std::string& path) const;
+    Decoded<TileSet> parseTileSet(const std::string& path) const;
+
+    template <typename T, typename U>
+    void startDecoding(std::unordered_map<std::string, Entry<T>>&, std::unordered_map<std::string, std::future<Decoded<U>>>&,
+        const std::vector<std::string>& ids, Decoded<U>(AssetManager::*decode)(const std::string&) const);
+    template <typename U>
+    Decoded<U> finishDecoding(std::unordered_map<std::string, std::future<Decoded<U>>>&, const std::string& id,
+        const std::string& path, Decoded<U>(AssetManager::*decode)(const std::string&) const);
+
+    template <typename T>
+    Entry<T>& find(std::unordered_map<std::string, Entry<T>>&, const std::string& id, const char* type);
+    template <typename T>
+    void loaded(Entry<T>&, std::size_t size);
+    template <typename T>
+    void findOldest(std::unordered_map<std::string, Entry<T>>&, sf::Uint64& oldest) const;
+    template <typename T>
+    bool evict(std::unordered_map<std::string, Entry<T>>&, sf::Uint64 lastUsed);
+    void evict(std::size_t budget);
+
+    sf::Texture& getFallbackTexture();
+};
+
+#endif //RM_ASSET_MANAGER_HPP_
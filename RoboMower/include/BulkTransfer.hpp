@@ -0,0 +1,136 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+//splits payloads which are too large for a single datagram into
+//fragments, and reassembles them at the other end. Fragments are sent
+//unreliably; the receiver reports which it has and the sender resends
+//only those which are missing. One instance is used per remote peer
+
+#ifndef RM_BULK_TRANSFER_HPP_
+#define RM_BULK_TRANSFER_HPP_
+
+#include <xygine/network/Config.hpp>
+
+#include <SFML/Network/Packet.hpp>
+
+#include <array>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+enum class BulkChannel : sf::Uint8
+{
+    Program = 0
+};
+
+class BulkTransfer final
+{
+public:
+    static const std::size_t FragmentSize = 1024;
+    static const std::size_t MaxFragments = 256;
+    static const std::size_t MaxSize = FragmentSize * MaxFragments;
+    static const std::size_t MaxTransfers = 4;
+
+    using SendFunction = std::function<void(sf::Packet&)>;
+    using ReceiveHandler = std::function<void(BulkChannel, std::vector<sf::Uint8>&)>;
+
+    BulkTransfer();
+    ~BulkTransfer() = default;
+
+    BulkTransfer(const BulkTransfer&) = delete;
+    BulkTransfer& operator = (const BulkTransfer&) = delete;
+
+    //the client ID is written after the packet ident, so the server knows who sent it
+    void setClientID(xy::ClientID id) { m_clientID = id; }
+    void setSendFunction(const SendFunction& func) { m_sendFunction = func; }
+    //called once a transfer has been completely received
+    void setReceiveHandler(const ReceiveHandler& handler) { m_receiveHandler = handler; }
+
+    /*!
+    \brief Queues data to be sent.
+    \returns false if the data is too large or too many transfers are in progress
+    */
+    bool send(BulkChannel, const std::vector<sf::Uint8>&);
+
+    /*!
+    \brief Handles Fragment and FragmentStatus packets. The packet should
+    have been read up to and including the client ID. Thread safe.
+    */
+    void handlePacket(xy::PacketID ident, sf::Packet&);
+
+    //sends queued fragments and handles resends and timeouts
+    void update(float);
+
+    void clear();
+
+private:
+    struct Outgoing final
+    {
+        sf::Uint16 id = 0;
+        BulkChannel channel = BulkChannel::Program;
+        std::vector<sf::Uint8> data;
+        std::vector<bool> acked;
+        std::vector<float> sendTimes;
+        std::size_t nextFragment = 0; //fragments before this have been sent at least once
+        float time = 0.f;
+        float lastStatus = 0.f;
+        float idleTime = 0.f;
+    };
+    std::vector<Outgoing> m_outgoing;
+    sf::Uint16 m_nextTransferID;
+
+    struct Incoming final
+    {
+        sf::Uint16 id = 0;
+        BulkChannel channel = BulkChannel::Program;
+        std::vector<sf::Uint8> data;
+        std::vector<bool> received;
+        std::size_t receivedCount = 0;
+        float statusTimer = 0.f;
+        float idleTime = 0.f;
+    };
+    std::vector<Incoming> m_incoming;
+
+    //recently completed transfers, so that late duplicates are acknowledged rather than restarted
+    std::array<sf::Uint16, 16> m_completed;
+    std::size_t m_completedIndex;
+
+    xy::ClientID m_clientID;
+    SendFunction m_sendFunction;
+    ReceiveHandler m_receiveHandler;
+    std::mutex m_mutex;
+
+    void sendFragment(Outgoing&, std::size_t);
+    void sendStatus(const Incoming&);
+    void sendComplete(sf::Uint16);
+    void handleFragment(sf::Packet&, std::vector<std::pair<BulkChannel, std::vector<sf::Uint8>>>&);
+    void handleStatus(sf::Packet&);
+};
+
+#endif //RM_BULK_TRANSFER_HPP_
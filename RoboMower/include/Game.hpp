@@ -33,20 +33,29 @@ source distribution.
 #include <xygine/App.hpp>
 
 #include <GameServer.hpp>
+#include <AssetManager.hpp>
+
+struct LaunchOptions;
 
 class Game final : public xy::App
 {
 public:
-    Game();
+    explicit Game(const LaunchOptions&);
     ~Game() = default;
     Game(const Game&) = delete;
     Game& operator = (const Game&) = delete;
 
 private:
 
+    //declared before the state stack so it outlives every state
+    AssetManager m_assets;
     xy::StateStack m_stateStack;
 
     GameServer m_server;
+    //passed to game states, which watch rather than play if it's set
+    bool m_spectating;
+    //how far behind the server remote mowers are drawn, in seconds
+    float m_interpolationDelay;
 
     void handleEvent(const sf::Event&) override;
     void handleMessage(const xy::Message&) override;
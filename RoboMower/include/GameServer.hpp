@@ -30,7 +30,17 @@ source distribution.
 #ifndef RM_GAME_SERVER_HPP_
 #define RM_GAME_SERVER_HPP_
 
-#include <xygine/network/ServerConnection.hpp>
+#include <PlayerRegistry.hpp>
+#include <ProgramStore.hpp>
+#include <Snapshot.hpp>
+#include <BulkTransfer.hpp>
+#include <TickProfiler.hpp>
+#include <ReplayRecorder.hpp>
+#include <PacketEnums.hpp>
+#include <PacketPool.hpp>
+#include <Link.hpp>
+
+#include <xygine/network/FlowControl.hpp>
 
 #include <xygine/Scene.hpp>
 #include <xygine/MessageBus.hpp>
@@ -40,6 +50,8 @@ namespace xy
     class Entity;
 }
 
+struct NetworkConditions;
+
 class GameServer final
 {
 public:
@@ -53,31 +65,115 @@ public:
     void stop();
     void update(float);
 
+    void setReplicationMode(ReplicationMode mode) { m_replicationMode = mode; }
+    //appends tick and traffic stats to the given file every interval seconds
+    void setProfilerOutput(const std::string& path, float interval) { m_profiler.setOutput(path, interval); }
+    //sessions are recorded to the given file when the server starts
+    void setRecordPath(const std::string& path) { m_recordPath = path; }
+    void setMaxClients(std::size_t count) { m_connection->setMaxClients(count); }
+    //replaces the default UDP link. Must be set before the server is started
+    void setLink(std::unique_ptr<ServerLink>);
+    //wraps the current link so that it behaves like a poor network. Call after setLink()
+    void setNetworkConditions(const NetworkConditions&);
+    //returns a link which clients in this process use to connect
+    std::unique_ptr<ClientLink> createLocalClient() { return m_connection->createLocalClient(); }
+
+    const TickProfiler& getProfiler() const { return m_profiler; }
+
 private:
-    struct Player final
+    //outgoing packets are built in pooled packets to save allocating each time.
+    //declared first as client states hold on to queued packets
+    PacketPool m_packetPool;
+
+    using Player = PlayerRegistry::Player;
+    PlayerRegistry m_players;
+
+    //per-client record of sent snapshots used as delta baselines,
+    //and the link estimates used to decide how often to send them.
+    //every connected client has one so that reliable messages reach
+    //spectators and clients which haven't joined yet
+    struct ClientState final
     {
-        std::string name;
-        xy::ClientID id = -1;
-        xy::Entity* entity = nullptr;
+        //only players are sent their own snapshots
+        bool player = false;
+        SnapshotHistory sentSnapshots;
+        std::array<float, SnapshotHistory::Size> sendTimes = {};
+        xy::Network::SeqID ackedSequence = 0;
+        bool acked = false;
+
+        xy::Network::FlowControl flowControl;
+        float roundTripTime = 0.f;
+        float lossRate = 0.f;
+        float lossScale = 1.f;
+        float sendRate = 20.f;
+        float sendAccumulator = 0.f;
+
+        sf::Uint32 snapshotsSent = 0;
+        sf::Uint32 snapshotsAcked = 0;
+        float statsAccumulator = 0.f;
+
+        //payloads too large for a single packet
+        BulkTransfer bulkTransfer;
+        //the program last announced with TransmitProgram, which an upload must match
+        ProgramStore::Digest expectedDigest = 0;
+        sf::Uint32 expectedSize = 0;
+
+        //reliable messages waiting to be batched at the end of the tick
+        std::vector<PacketPool::Handle> messages;
     };
-    std::vector<Player> m_players;
+    std::unordered_map<xy::ClientID, ClientState> m_clientStates;
 
     xy::MessageBus m_messageBus; //TODO server should be encapsulated and have its own messages, right?
     xy::Scene m_scene;
 
-    xy::Network::ServerConnection m_connection;
-    xy::Network::ServerConnection::PacketHandler m_packetHandler;
+    std::unique_ptr<ServerLink> m_connection;
     sf::Clock m_snapshotClock;
-    float m_snapshotAccumulator;
+    float m_serverTime;
+    xy::Network::SeqID m_snapshotSequence;
+    Snapshot m_currentSnapshot;
+
+    ReplicationMode m_replicationMode;
+    float m_checksumAccumulator;
+
+    //spectators share a single snapshot stream
+    std::vector<xy::ClientID> m_spectators;
+    std::array<Snapshot, 2> m_spectatorSnapshots;
+    float m_spectatorAccumulator;
+    xy::Network::SeqID m_spectatorSequence;
+    sf::Uint32 m_spectatorFrameCount;
+
+    TickProfiler m_profiler;
+    ProgramStore m_programStore;
+
+    std::string m_recordPath;
+    ReplayRecorder m_recorder;
 
     void handleMessage(const xy::Message&);
 
+    //all outgoing packets go through these so traffic can be profiled.
+    //reliable packets are queued and sent in batches by flushMessages()
+    void send(xy::ClientID, sf::Packet&, bool retry = false);
+    void broadcast(sf::Packet&, bool retry = false);
+    void flushMessages(xy::ClientID, ClientState&);
+
     void setup();
-    void addPlayer(Player&);
+    //creates the state for a client the first time it's heard from
+    ClientState& addClient(xy::ClientID);
+    void addPlayer(const Player&);
     void removePlayer(xy::ClientID);
-    void sendSnapshot();
-
-    void handlePacket(const sf::IpAddress&, xy::PortNumber, xy::Network::PacketType, sf::Packet&, xy::Network::ServerConnection*);
+    //tells a client which slot every other player uses
+    void sendRoster(xy::ClientID);
+    void buildSnapshot(Snapshot&, xy::Network::SeqID);
+    bool sendSnapshot(xy::ClientID, ClientState&);
+    void updateSendRate(xy::ClientID, ClientState&, float);
+    void updateSpectators(float);
+    void sendChecksums();
+    void replicateTransport(const Player&, TransportChange);
+    void updateStepBudgets();
+    void setProgram(xy::ClientID, const ProgramStore::Program&);
+    void handleBulkData(xy::ClientID, BulkChannel, std::vector<sf::Uint8>&);
+
+    void handlePacket(xy::ClientID, xy::Network::PacketType, sf::Packet&);
 };
 
 #endif //RM_GAME_SERVER_HPP_
\ No newline at end of file
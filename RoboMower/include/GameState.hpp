@@ -35,13 +35,18 @@ source distribution.
 #include <StateIds.hpp>
 #include <InstructionSet.hpp>
 #include <GameUI.hpp>
+#include <AssetManager.hpp>
+#include <Snapshot.hpp>
+#include <ProgramStore.hpp>
+#include <BulkTransfer.hpp>
+#include <Link.hpp>
+#include <components/NetworkController.hpp>
+#include <components/PlayerLogic.hpp>
 
 #include <xygine/State.hpp>
 #include <xygine/Entity.hpp>
 #include <xygine/Scene.hpp>
-#include <xygine/Resource.hpp>
 #include <xygine/ui/Window.hpp>
-#include <xygine/network/ClientConnection.hpp>
 
 #include <SFML/Graphics/Text.hpp>
 #include <SFML/Graphics/RectangleShape.hpp>
@@ -49,17 +54,25 @@ source distribution.
 #include <SFML/Graphics/Sprite.hpp>
 #include <SFML/Network/TcpSocket.hpp>
 
+#include <deque>
 #include <map>
+#include <vector>
 
 namespace sf
 {
     class Color;
 }
 
+class GameServer;
+class ClippingParticles;
+
 class GameState final : public xy::State
 {
 public:
-    GameState(xy::StateStack& stateStack, Context context);
+    //spectators watch everyone else's mowers rather than controlling their own.
+    //Remote mowers are drawn at least interpolationDelay seconds behind the server
+    GameState(xy::StateStack& stateStack, Context context, AssetManager& assets,
+        GameServer& server, const bool& spectating, const float& interpolationDelay);
     ~GameState() = default;
 
     bool update(float dt) override;
@@ -73,22 +86,74 @@ public:
 private:
 
     xy::MessageBus& m_messageBus;
+    AssetManager::Lease m_assets;
     xy::Scene m_scene;
 
-    xy::TextureResource m_textureResource;
-    xy::FontResource m_fontResource;
-
     GameUI m_gameUI;
-    xy::Network::ClientConnection m_connection;
+    std::unique_ptr<ClientLink> m_connection;
     bool m_programFinished;
+    //held until the server says whether it needs uploading
+    ProgramStore::Program m_pendingProgram;
+    BulkTransfer m_bulkTransfer;
+
+    //mowers are found by the compact slot the server gives each player,
+    //so snapshots can index straight in. Remote mowers come from a pool
+    //built while loading, so people coming and going doesn't stall the game
+    struct PlayerSlot final
+    {
+        xy::ClientID id = xy::Network::NullID;
+        xy::Entity* entity = nullptr;
+    };
+    std::vector<PlayerSlot> m_playerSlots;
+    std::vector<xy::Entity::Ptr> m_playerPool;
+    xy::Entity* m_localPlayer;
+    xy::Entity* m_mapEntity;
+    ClippingParticles* m_clippings;
+
+    ReplicationMode m_replicationMode;
+    //when each outstanding request was sent, in server time
+    std::map<xy::ClientID, float> m_resyncRequests;
+
+    SnapshotHistory m_snapshots;
+    Snapshot m_latestSnapshot;
+    bool m_hasSnapshot;
+    InterpolationClock m_interpolationClock;
+
+    //the local mower is simulated as soon as input is given, rather
+    //than waiting for the server, and corrected when the two disagree
+    sf::Vector2f m_predictionError;
+    float m_resyncTime;
+
+    //spectator snapshots are buffered so that mowers appear, leave
+    //and turn in step with the interpolated positions
+    bool m_spectating;
+    struct SpectatorFrame final
+    {
+        float serverTime = 0.f;
+        Snapshot snapshot;
+    };
+    std::deque<SpectatorFrame> m_spectatorFrames;
 
-    std::map<xy::ClientID, xy::Entity*> m_playerEntities;
-
-    xy::Network::ClientConnection::PacketHandler m_packetHandler;
-    void handlePacket(xy::Network::PacketType type, sf::Packet& packet, xy::Network::ClientConnection* connection);
+    void handlePacket(xy::Network::PacketType type, sf::Packet& packet);
 
     void buildMap();
+    xy::Entity::Ptr createPlayerEntity(bool local);
+    void spawnPlayer(xy::ClientID, sf::Uint16 slot);
+    void despawnPlayer(xy::ClientID);
+    xy::Entity* getPlayerEntity(xy::ClientID) const;
+    xy::Entity* getSlotEntity(sf::Uint16) const;
+    void updateSpectating();
+    void applySpectatorFrame(const SpectatorFrame&);
+    void setPlayerDirection(xy::Entity&, Direction);
+    bool isLocalPlayer(xy::ClientID) const;
+    void predictTransport(TransportChange);
+    void reconcile(float serverTime, sf::Uint32 tick, sf::Uint32 hash);
+    void correctPrediction(float serverTime, const PlayerLogic::State&);
+    PlayerLogic* getPlayerLogic(xy::ClientID);
+    void requestResync(xy::ClientID);
+    void requestNextSpeed();
     void sendProgram();
+    void uploadProgram();
 };
 
 #endif //GAME_STATE_HPP_
\ No newline at end of file
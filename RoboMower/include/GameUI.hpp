@@ -36,6 +36,7 @@ source distribution.
 
 #include <InstructionSet.hpp>
 #include <PacketEnums.hpp>
+#include <AssetManager.hpp>
 
 #include <xygine/State.hpp>
 #include <xygine/ShaderResource.hpp>
@@ -52,14 +53,12 @@ namespace xy
     class Entity;
     class MessageBus;
     class App;
-    class TextureResource;
-    class FontResource;
 }
 
 class GameUI final
 {
 public:
-    GameUI(xy::State::Context, xy::TextureResource&, xy::FontResource&, xy::Scene&);
+    GameUI(xy::State::Context, AssetManager::Lease&, xy::Scene&);
     ~GameUI() = default;
     GameUI(const GameUI&) = delete;
     GameUI& operator = (const GameUI&) = delete;
@@ -76,8 +75,7 @@ public:
 
 private:
     xy::ShaderResource m_shaderResource;
-    xy::FontResource& m_fontResource;
-    xy::TextureResource& m_textureResource;
+    AssetManager::Lease& m_assets;
 
     TransportStatus m_transportStatus;
 
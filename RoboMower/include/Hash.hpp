@@ -0,0 +1,68 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+//FNV-1a hashing used to compare program and simulation state across the
+//network, and SHA-256 for content addressing, where a client must not be
+//able to craft a collision with someone else's data
+
+#ifndef RM_HASH_HPP_
+#define RM_HASH_HPP_
+
+#include <SFML/Config.hpp>
+
+#include <array>
+#include <cstddef>
+
+namespace Hash
+{
+    static const sf::Uint32 Seed = 2166136261u;
+
+    static inline sf::Uint32 fnv1a(const void* data, std::size_t size, sf::Uint32 hash = Seed)
+    {
+        const auto* bytes = static_cast<const sf::Uint8*>(data);
+        for (auto i = 0u; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    using Sha256Digest = std::array<sf::Uint8, 32>;
+    Sha256Digest sha256(const void* data, std::size_t size);
+
+    //hashes the object representation so should only be used with trivial types
+    template <typename T>
+    static inline sf::Uint32 combine(sf::Uint32 hash, const T& value)
+    {
+        return fnv1a(&value, sizeof(T), hash);
+    }
+}
+
+#endif //RM_HASH_HPP_
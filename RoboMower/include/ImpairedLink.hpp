@@ -0,0 +1,175 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+//links which wrap another link and make it behave like a poor network,
+//so that interpolation and reliability can be tuned without leaving the
+//machine. Outgoing packets are held back, dropped, duplicated or
+//reordered before being passed on. All random choices come from a seeded
+//generator so that runs can be repeated
+
+#ifndef RM_IMPAIRED_LINK_HPP_
+#define RM_IMPAIRED_LINK_HPP_
+
+#include <Link.hpp>
+#include <PacketPool.hpp>
+
+#include <SFML/System/Clock.hpp>
+
+#include <deque>
+#include <random>
+#include <unordered_map>
+
+struct NetworkConditions final
+{
+    //one way delay in milliseconds, plus up to jitter milliseconds at random
+    float latency = 0.f;
+    float jitter = 0.f;
+    //chance of a packet being lost, and the average length of a run of
+    //losses. Lost reliable packets arrive late instead, as if resent
+    float loss = 0.f;
+    float lossBurst = 1.f;
+    //chance of an unreliable packet arriving twice, or being held back
+    //long enough for later packets to overtake it
+    float duplication = 0.f;
+    float reordering = 0.f;
+    //kilobits per second. 0 is unlimited
+    float bandwidth = 0.f;
+    sf::Uint32 seed = 0;
+
+    bool enabled() const
+    {
+        return latency > 0.f || jitter > 0.f || loss > 0.f || duplication > 0.f
+            || reordering > 0.f || bandwidth > 0.f;
+    }
+};
+
+//holds outgoing packets until they are due to arrive. Each client ID,
+//with broadcasts as one more, is a separate link with its own bandwidth,
+//loss bursts and reliable ordering, so trouble on one doesn't hold up others
+class NetworkImpairment final
+{
+public:
+    using SendFunc = std::function<void(xy::ClientID, sf::Packet&, bool)>;
+
+    explicit NetworkImpairment(const NetworkConditions&);
+
+    void push(xy::ClientID, const sf::Packet&, bool reliable);
+    //passes on everything which is now due
+    void flush(const SendFunc&);
+    void clear();
+
+    std::size_t getQueuedCount() const { return m_queue.size(); }
+
+private:
+    struct Delayed final
+    {
+        sf::Time due;
+        xy::ClientID clientID = xy::Network::NullID;
+        bool reliable = false;
+        PacketPool::Handle packet;
+    };
+
+    struct Stream final
+    {
+        //when the capped link is free to send again
+        sf::Time linkFreeTime;
+        //reliable packets are never overtaken by each other
+        sf::Time lastReliableTime;
+        bool inLossBurst = false;
+    };
+    std::unordered_map<xy::ClientID, Stream> m_streams;
+
+    NetworkConditions m_conditions;
+    std::mt19937 m_generator;
+    std::uniform_real_distribution<float> m_distribution;
+
+    PacketPool m_pool;
+    //sorted by due time
+    std::deque<Delayed> m_queue;
+    sf::Clock m_clock;
+
+    float roll() { return m_distribution(m_generator); }
+    bool lose(Stream&);
+    sf::Time delay();
+    void insert(Delayed&&);
+};
+
+class ImpairedClientLink final : public ClientLink
+{
+public:
+    ImpairedClientLink(std::unique_ptr<ClientLink>, const NetworkConditions&);
+    ~ImpairedClientLink() = default;
+
+    ImpairedClientLink(const ImpairedClientLink&) = delete;
+    ImpairedClientLink& operator = (const ImpairedClientLink&) = delete;
+
+    bool connect() override { return m_link->connect(); }
+    void disconnect() override;
+    void update(float) override;
+    bool send(sf::Packet&, bool) override;
+
+    bool connected() const override { return m_link->connected(); }
+    xy::ClientID getClientID() const override { return m_link->getClientID(); }
+    sf::Time getTime() const override { return m_link->getTime(); }
+
+private:
+    std::unique_ptr<ClientLink> m_link;
+    NetworkImpairment m_impairment;
+};
+
+//clients created with createLocalClient() are impaired too, each
+//with its own seed, so that traffic in both directions is affected
+class ImpairedServerLink final : public ServerLink
+{
+public:
+    ImpairedServerLink(std::unique_ptr<ServerLink>, const NetworkConditions&);
+    ~ImpairedServerLink() = default;
+
+    ImpairedServerLink(const ImpairedServerLink&) = delete;
+    ImpairedServerLink& operator = (const ImpairedServerLink&) = delete;
+
+    bool start() override { return m_link->start(); }
+    void stop() override;
+    void update(float) override;
+    //broadcasts are impaired once, so every client sees the same losses
+    //and delays, which are separate from those of packets sent to each
+    bool send(xy::ClientID, sf::Packet&, bool) override;
+    void broadcast(sf::Packet&, bool) override;
+    void setMaxClients(std::size_t count) override { m_link->setMaxClients(count); }
+
+    std::unique_ptr<ClientLink> createLocalClient() override;
+
+private:
+    std::unique_ptr<ServerLink> m_link;
+    NetworkConditions m_conditions;
+    NetworkImpairment m_impairment;
+    sf::Uint32 m_clientCount;
+};
+
+#endif //RM_IMPAIRED_LINK_HPP_
@@ -0,0 +1,77 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+//options which can be set from the command line when launching the game
+
+#ifndef RM_LAUNCH_OPTIONS_HPP_
+#define RM_LAUNCH_OPTIONS_HPP_
+
+#include <PacketEnums.hpp>
+#include <ImpairedLink.hpp>
+
+#include <string>
+
+struct LaunchOptions final
+{
+    ReplicationMode replicationMode = ReplicationMode::Snapshots;
+
+    //local games don't need to go through a socket unless
+    //other machines are going to connect
+    enum class Link
+    {
+        Loopback,
+        Udp
+    }link = Link::Loopback;
+
+    //simulated network conditions, applied in both directions
+    NetworkConditions network;
+
+    //the least time remote mowers are drawn behind the server, so
+    //that late updates still arrive in time to be interpolated
+    float interpolationDelay = 0.1f;
+
+    //joins games as a spectator rather than a player
+    bool spectate = false;
+
+    //server stats are only written to file if a path is given
+    std::string profilerOutput;
+    float profilerInterval = 5.f;
+
+    //the server records sessions to this file if it's set
+    std::string recordPath;
+    //plays back a recorded session without opening a window.
+    //a speed of 0 plays it back as fast as possible
+    std::string replayPath;
+    float replaySpeed = 0.f;
+
+    //unrecognised arguments are logged and ignored
+    static LaunchOptions parse(int argc, char** argv);
+};
+
+#endif //RM_LAUNCH_OPTIONS_HPP_
\ No newline at end of file
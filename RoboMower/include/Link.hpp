@@ -0,0 +1,99 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+//the connection between GameServer and its clients. Links may go over
+//the network, or for local games stay entirely within the process.
+//Packets passed to handlers have already had their PacketID read
+
+#ifndef RM_LINK_HPP_
+#define RM_LINK_HPP_
+
+#include <xygine/network/Config.hpp>
+
+#include <SFML/System/Time.hpp>
+
+#include <functional>
+#include <memory>
+
+namespace sf
+{
+    class Packet;
+}
+
+class ClientLink
+{
+public:
+    using PacketHandler = std::function<void(xy::Network::PacketType, sf::Packet&)>;
+
+    virtual ~ClientLink() = default;
+
+    virtual bool connect() = 0;
+    virtual void disconnect() = 0;
+    virtual void update(float) = 0;
+    //reliable packets are resent until acknowledged
+    virtual bool send(sf::Packet&, bool reliable = false) = 0;
+
+    virtual bool connected() const = 0;
+    virtual xy::ClientID getClientID() const = 0;
+    //time elapsed according to the server
+    virtual sf::Time getTime() const = 0;
+
+    void setPacketHandler(const PacketHandler& handler) { m_packetHandler = handler; }
+
+protected:
+    PacketHandler m_packetHandler;
+};
+
+class ServerLink
+{
+public:
+    using PacketHandler = std::function<void(xy::ClientID, xy::Network::PacketType, sf::Packet&)>;
+    using TimeoutHandler = std::function<void(xy::ClientID)>;
+
+    virtual ~ServerLink() = default;
+
+    virtual bool start() = 0;
+    virtual void stop() = 0;
+    virtual void update(float) = 0;
+    virtual bool send(xy::ClientID, sf::Packet&, bool reliable = false) = 0;
+    virtual void broadcast(sf::Packet&, bool reliable = false) = 0;
+    virtual void setMaxClients(std::size_t) = 0;
+
+    //creates a client link suitable for connecting to this server from the same process
+    virtual std::unique_ptr<ClientLink> createLocalClient() = 0;
+
+    void setPacketHandler(const PacketHandler& handler) { m_packetHandler = handler; }
+    void setTimeoutHandler(const TimeoutHandler& handler) { m_timeoutHandler = handler; }
+
+protected:
+    PacketHandler m_packetHandler;
+    TimeoutHandler m_timeoutHandler;
+};
+
+#endif //RM_LINK_HPP_
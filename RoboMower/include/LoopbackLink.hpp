@@ -0,0 +1,110 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+//links which pass packets between a server and clients in the same
+//process through lock free queues, without touching the network. Nothing
+//is lost or reordered, so reliable and unreliable sends are treated the
+//same. Packet handlers are called from update() on the thread owning
+//each end, rather than from a listen thread. A sent packet is copied
+//once into a pooled packet, which the receiving handler then reads
+//directly before it's returned to the pool
+
+#ifndef RM_LOOPBACK_LINK_HPP_
+#define RM_LOOPBACK_LINK_HPP_
+
+#include <Link.hpp>
+
+#include <SFML/Network/Packet.hpp>
+#include <SFML/System/Clock.hpp>
+
+#include <memory>
+#include <vector>
+
+struct LoopbackChannel;
+class PacketPool;
+
+class LoopbackClientLink final : public ClientLink
+{
+public:
+    explicit LoopbackClientLink(const std::shared_ptr<LoopbackChannel>&);
+    ~LoopbackClientLink();
+
+    LoopbackClientLink(const LoopbackClientLink&) = delete;
+    LoopbackClientLink& operator = (const LoopbackClientLink&) = delete;
+
+    bool connect() override;
+    void disconnect() override;
+    void update(float) override;
+    bool send(sf::Packet&, bool) override;
+
+    bool connected() const override { return m_connected; }
+    xy::ClientID getClientID() const override { return m_clientID; }
+    sf::Time getTime() const override;
+
+private:
+    std::shared_ptr<LoopbackChannel> m_channel;
+    bool m_connected;
+    xy::ClientID m_clientID;
+
+    //server time when we connected, and how long ago that was
+    sf::Time m_connectTime;
+    sf::Clock m_clock;
+};
+
+class LoopbackServerLink final : public ServerLink
+{
+public:
+    LoopbackServerLink();
+    ~LoopbackServerLink();
+
+    LoopbackServerLink(const LoopbackServerLink&) = delete;
+    LoopbackServerLink& operator = (const LoopbackServerLink&) = delete;
+
+    bool start() override;
+    void stop() override;
+    void update(float) override;
+    bool send(xy::ClientID, sf::Packet&, bool) override;
+    void broadcast(sf::Packet&, bool) override;
+    void setMaxClients(std::size_t count) override { m_maxClients = count; }
+
+    std::unique_ptr<ClientLink> createLocalClient() override;
+
+private:
+    //shared with the channels, as clients may hold on to theirs after we've gone
+    std::shared_ptr<PacketPool> m_pool;
+    std::vector<std::shared_ptr<LoopbackChannel>> m_channels;
+    std::size_t m_maxClients;
+    xy::ClientID m_nextClientID;
+    bool m_running;
+    sf::Clock m_clock;
+
+    std::size_t connectedCount() const;
+};
+
+#endif //RM_LOOPBACK_LINK_HPP_
@@ -33,9 +33,9 @@ source distribution.
 #define MENU_BACKGROUND_STATE_HPP_
 
 #include <StateIds.hpp>
+#include <AssetManager.hpp>
 
 #include <xygine/State.hpp>
-#include <xygine/Resource.hpp>
 #include <xygine/ui/Container.hpp>
 
 #include <SFML/Graphics/Text.hpp>
@@ -49,7 +49,7 @@ namespace xy
 class MenuBackgroundState final : public xy::State
 {
 public:
-    MenuBackgroundState(xy::StateStack&, Context);
+    MenuBackgroundState(xy::StateStack&, Context, AssetManager&);
     ~MenuBackgroundState() = default;
 
     bool update(float) override;
@@ -62,8 +62,8 @@ public:
     }
 private:
     xy::MessageBus& m_messageBus;
+    AssetManager::Lease m_assets;
     xy::UI::Container m_uiContainer;
-    xy::FontResource m_fontResource;
 
     std::vector<sf::Text> m_texts;
 };
@@ -33,9 +33,9 @@ source distribution.
 #define MENU_JOIN_STATE_HPP_
 
 #include <StateIds.hpp>
+#include <AssetManager.hpp>
 
 #include <xygine/State.hpp>
-#include <xygine/Resource.hpp>
 
 #include <xygine/ui/Container.hpp>
 #include <xygine/ui/Label.hpp>
@@ -49,7 +49,7 @@ namespace xy
 class MenuJoinState final : public xy::State
 {
 public:
-    MenuJoinState(xy::StateStack&, Context);
+    MenuJoinState(xy::StateStack&, Context, AssetManager&);
     ~MenuJoinState() = default;
 
     bool update(float) override;
@@ -62,14 +62,12 @@ public:
     }
 private:
     xy::MessageBus& m_messageBus;
+    AssetManager::Lease m_assets;
     xy::UI::Container m_uiContainer;
     sf::Sprite m_cursorSprite;
 
     xy::UI::Label::Ptr m_statusLabel;
 
-    xy::TextureResource m_textureResource;
-    xy::FontResource m_fontResource;
-
     void buildMenu();
     void sendCloseMessage();
 };
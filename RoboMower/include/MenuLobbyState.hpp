@@ -33,10 +33,10 @@ source distribution.
 #define MENU_LOBBY_STATE_HPP_
 
 #include <StateIds.hpp>
+#include <AssetManager.hpp>
 
 #include <xygine/State.hpp>
 #include <xygine/ui/Container.hpp>
-#include <xygine/Resource.hpp>
 
 #include <SFML/Graphics/Text.hpp>
 #include <SFML/Graphics/Sprite.hpp>
@@ -51,7 +51,7 @@ namespace xy
 class MenuLobbyState final : public xy::State
 {
 public:
-    MenuLobbyState(xy::StateStack&, Context);
+    MenuLobbyState(xy::StateStack&, Context, AssetManager&);
     ~MenuLobbyState() = default;
 
     bool update(float) override;
@@ -65,6 +65,7 @@ public:
 
 private:
     xy::MessageBus& m_messageBus;
+    AssetManager::Lease m_assets;
     xy::UI::Container m_uiContainer;
 
     std::map<sf::Int16, sf::Text> m_texts;
@@ -72,9 +73,6 @@ private:
 
     sf::Font& m_font;
 
-    xy::TextureResource m_textureResource;
-    xy::FontResource m_fontResource;
-
     void buildMenu();
 };
 #endif //MENU_LOBBY_STATE_HPP_
\ No newline at end of file
@@ -33,10 +33,10 @@ source distribution.
 #define MENU_MAIN_STATE_HPP_
 
 #include <StateIds.hpp>
+#include <AssetManager.hpp>
 
 #include <xygine/State.hpp>
 #include <xygine/ui/Container.hpp>
-#include <xygine/Resource.hpp>
 
 #include <SFML/Graphics/Sprite.hpp>
 
@@ -47,7 +47,7 @@ namespace xy
 class MenuMainState final : public xy::State
 {
 public:
-    MenuMainState(xy::StateStack&, Context);
+    MenuMainState(xy::StateStack&, Context, AssetManager&);
     ~MenuMainState() = default;
 
     bool update(float) override;
@@ -60,12 +60,10 @@ public:
     }
 private:
     xy::MessageBus& m_messageBus;
+    AssetManager::Lease m_assets;
     xy::UI::Container m_uiContainer;
     sf::Sprite m_cursorSprite;
 
-    xy::TextureResource m_textureResource;
-    xy::FontResource m_fontResource;
-
     void buildMenu();
     void close();
 };
@@ -31,10 +31,10 @@ source distribution.
 #define MENU_OPTION_STATE_HPP_
 
 #include <StateIds.hpp>
+#include <AssetManager.hpp>
 
 #include <xygine/State.hpp>
 #include <xygine/ui/Container.hpp>
-#include <xygine/Resource.hpp>
 
 #include <SFML/Graphics/Sprite.hpp>
 #include <SFML/Graphics/Text.hpp>
@@ -46,7 +46,7 @@ namespace xy
 class MenuOptionState final : public xy::State
 {
 public:
-    MenuOptionState(xy::StateStack& stateStack, Context context);
+    MenuOptionState(xy::StateStack& stateStack, Context context, AssetManager& assets);
     ~MenuOptionState() = default;
 
     bool update(float dt) override;
@@ -59,15 +59,13 @@ public:
     }
 private:
     xy::MessageBus& m_messageBus;
+    AssetManager::Lease m_assets;
     sf::Sprite m_menuSprite;
     sf::Sprite m_cursorSprite;
     std::vector<sf::Text> m_texts;
 
     xy::UI::Container m_uiContainer;
 
-    xy::TextureResource m_textureResource;
-    xy::FontResource m_fontResource;
-
     void buildMenu(const sf::Font&);
     void close();
 };
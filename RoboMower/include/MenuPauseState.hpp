@@ -33,10 +33,10 @@ source distribution.
 #define PAUSE_STATE_HPP_
 
 #include <StateIds.hpp>
+#include <AssetManager.hpp>
 
 #include <xygine/State.hpp>
 #include <xygine/ui/Container.hpp>
-#include <xygine/Resource.hpp>
 
 #include <SFML/Graphics/Text.hpp>
 #include <SFML/Graphics/Sprite.hpp>
@@ -50,7 +50,7 @@ namespace xy
 class MenuPauseState final : public xy::State
 {
 public:
-    MenuPauseState(xy::StateStack&, Context);
+    MenuPauseState(xy::StateStack&, Context, AssetManager&);
     ~MenuPauseState() = default;
 
     bool update(float) override;
@@ -63,14 +63,12 @@ public:
     }
 private:
     xy::MessageBus& m_messageBus;
+    AssetManager::Lease m_assets;
     xy::UI::Container m_uiContainer;
     sf::Sprite m_cursorSprite;
 
     std::vector<sf::Text> m_texts;
 
-    xy::TextureResource m_textureResource;
-    xy::FontResource m_fontResource;
-
     void buildMenu(const sf::Font&);
     void sendCloseMessage();
 };
@@ -32,25 +32,152 @@ source distribution.
 
 #include <xygine/network/Config.hpp>
 
+#include <functional>
+#include <vector>
+
 enum PacketIdent
 {
     //client id, name
     PlayerDetails = xy::PacketID(xy::Network::PacketType::Count),
-    //count, client id, position
+    //server time, recipient's simulation tick and state hash, then bit packed: sequence, baseline offset, slot size, changed count, [slot, field mask, fields], removed count, [slot]
     PositionUpdate,
     //clientId, direction
     DirectionUpdate,
-    //clientID, size, bytestream
+    //clientID, program digest, size
     TransmitProgram,
     //transport state
     TransportStateChanged,
     //clientID, transport state
     TransportRequestChange,
     //action
-    ProgramStatus
+    ProgramStatus,
+    //clientID, sequence of most recent snapshot received
+    SnapshotAck,
+    //replication mode
+    ServerSettings,
+    //clientID, blob
+    ReplicateProgram,
+    //clientID, transport change, simulation tick
+    ReplicateTransport,
+    //clientID, simulation tick, state hash
+    StateChecksum,
+    //requesting clientID, clientID of player to resync
+    ResyncRequest,
+    //clientID, server time, player state
+    PlayerState,
+    //clientID, transfer ID, channel, fragment count, total size, fragment index, blob
+    Fragment,
+    //clientID, transfer ID, complete, bit packed: [fragment received]
+    FragmentStatus,
+    //clientID, transport speed
+    TransportRequestSpeed,
+    //clientID, transport speed, simulation tick
+    TransportSpeedChanged,
+    //message count, [message size], [message]
+    MessageBatch,
+    //clientID, name
+    SpectatorDetails,
+    //server time, bit packed snapshot as PositionUpdate
+    SpectatorSnapshot,
+    //clientID, slot, name
+    PlayerJoined,
+    //clientID
+    PlayerLeft
 };
 
 sf::Packet& operator << (sf::Packet&, PacketIdent);
 sf::Packet& operator >> (sf::Packet&, PacketIdent&);
 
+//packs values into the fewest number of bits needed for their range.
+//the packed stream is written to a packet as a length prefixed block
+//which must be the last field of the packet
+class BitWriter final
+{
+public:
+    BitWriter();
+
+    void write(sf::Uint32 value, sf::Uint8 bitCount);
+    void writeBool(bool value) { write(value ? 1 : 0, 1); }
+    //values are clamped to [min, max]
+    void writeRanged(sf::Int32 value, sf::Int32 min, sf::Int32 max);
+    //values are clamped to [min, max] and quantised to the given precision
+    void writeQuantised(float value, float min, float max, float precision);
+
+    void clear();
+    //flushes any partially written byte
+    const std::vector<sf::Uint8>& getData();
+    std::size_t getBitCount() const { return m_bitCount; }
+
+private:
+    std::vector<sf::Uint8> m_data;
+    sf::Uint64 m_scratch;
+    sf::Uint8 m_scratchBits;
+    std::size_t m_bitCount;
+};
+
+class BitReader final
+{
+public:
+    BitReader();
+    BitReader(const void* data, std::size_t size);
+
+    sf::Uint32 read(sf::Uint8 bitCount);
+    bool readBool() { return read(1) != 0; }
+    sf::Int32 readRanged(sf::Int32 min, sf::Int32 max);
+    float readQuantised(float min, float max, float precision);
+
+    //false if an attempt was made to read past the end of the data
+    bool valid() const { return m_valid; }
+
+private:
+    const sf::Uint8* m_data;
+    std::size_t m_size;
+    std::size_t m_bitPosition;
+    bool m_valid;
+};
+
+namespace Bits
+{
+    //returns the number of bits required to store values in [0, range]
+    sf::Uint8 required(sf::Uint32 range);
+}
+
+sf::Packet& operator << (sf::Packet&, BitWriter&);
+//the reader refers to the packet data so must not outlive it
+sf::Packet& operator >> (sf::Packet&, BitReader&);
+
+//length prefixed byte blocks copied to and from packets in one go
+//rather than a byte at a time. Like bit streams they must be the
+//last field of the packet
+namespace Blob
+{
+    void write(sf::Packet&, const std::vector<sf::Uint8>&);
+    //returns false if the packet doesn't contain a complete blob
+    bool read(sf::Packet&, std::vector<sf::Uint8>&);
+}
+
+//small reliable messages sent to the same client in one tick are packed
+//into batches, so they share a datagram and are acknowledged together.
+//Each message is a complete packet including its PacketIdent
+namespace Batch
+{
+    //keeps batches under a typical MTU once the connection's header is added
+    const std::size_t MaxSize = 1200;
+    const std::size_t MaxCount = 255;
+    //the ident and message count
+    const std::size_t HeaderSize = 2;
+    //the size prefix of each message
+    const std::size_t EntrySize = 2;
+
+    //the batch packet must already have had its ident read. Each message
+    //is passed to the handler with its ident still to be read.
+    //Returns false if the batch is malformed
+    bool read(sf::Packet&, const std::function<void(sf::Packet&)>& handler);
+}
+
+//programs are replicated to other clients as a single reliable message,
+//so must fit in one batch along with the ReplicateProgram header. This
+//also keeps them within the 16 bit lengths of Blob and replay events
+const std::size_t MaxProgramSize = 1024;
+
 #endif //RM_NET_PROTOCOL_HPP_
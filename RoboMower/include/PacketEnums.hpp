@@ -46,6 +46,33 @@ enum class TransportChange : sf::Uint8
     Rewind
 };
 
+//rate at which programs are played back. The simulation always uses
+//the same time step so programs have the same result at any speed
+enum class TransportSpeed : sf::Uint8
+{
+    Normal,
+    Double,
+    Quadruple,
+    Octuple,
+    //as many steps as the server has time for
+    Max,
+    Count
+};
+
+//returns 0 for Max, which has no fixed rate
+static inline float getSpeedMultiplier(TransportSpeed speed)
+{
+    switch (speed)
+    {
+    default:
+    case TransportSpeed::Normal: return 1.f;
+    case TransportSpeed::Double: return 2.f;
+    case TransportSpeed::Quadruple: return 4.f;
+    case TransportSpeed::Octuple: return 8.f;
+    case TransportSpeed::Max: return 0.f;
+    }
+}
+
 enum class Direction : sf::Uint8
 {
     Left = 0,
@@ -59,7 +86,22 @@ enum class ProgramState : sf::Uint8
 {
     Finished = 0,
     Rewound,
-    Resend
+    Resend,
+    //replies to a program digest: the server already has the program...
+    Stored,
+    //...or needs the client to upload it...
+    Upload,
+    //...or won't accept it, because it's too large or conflicts with a stored one
+    Rejected
+};
+
+//how the server keeps clients up to date with mower movement
+enum class ReplicationMode : sf::Uint8
+{
+    //positions are streamed as snapshots
+    Snapshots,
+    //programs and transport changes are sent and clients simulate them
+    Events
 };
 
 sf::Packet& operator << (sf::Packet& p, TransportStatus ts);
@@ -68,10 +110,16 @@ sf::Packet& operator >> (sf::Packet& p, TransportStatus& ts);
 sf::Packet& operator << (sf::Packet& p, TransportChange tc);
 sf::Packet& operator >> (sf::Packet& p, TransportChange& ts);
 
+sf::Packet& operator << (sf::Packet&, TransportSpeed);
+sf::Packet& operator >> (sf::Packet&, TransportSpeed&);
+
 sf::Packet& operator << (sf::Packet&, Direction);
 sf::Packet& operator >> (sf::Packet&, Direction&);
 
 sf::Packet& operator << (sf::Packet&, ProgramState);
 sf::Packet& operator >> (sf::Packet&, ProgramState&);
 
+sf::Packet& operator << (sf::Packet&, ReplicationMode);
+sf::Packet& operator >> (sf::Packet&, ReplicationMode&);
+
 #endif //RM_PACKET_ENUMS_HPP_
\ No newline at end of file
@@ -0,0 +1,102 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+//pool of reusable packets. Cleared packets keep their buffer, so once
+//the pool has warmed up building a packet allocates nothing. Handles are
+//reference counted so that one packet can be shared, for example by
+//every client a broadcast is queued for, and is returned to the pool
+//when the last handle goes
+
+#ifndef RM_PACKET_POOL_HPP_
+#define RM_PACKET_POOL_HPP_
+
+#include <SFML/Network/Packet.hpp>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class PacketPool final
+{
+    struct Entry;
+
+public:
+    class Handle final
+    {
+    public:
+        Handle() = default;
+        ~Handle() { reset(); }
+
+        Handle(const Handle&);
+        Handle& operator = (const Handle&);
+        Handle(Handle&&);
+        Handle& operator = (Handle&&);
+
+        sf::Packet& operator * () const;
+        sf::Packet* operator -> () const;
+        explicit operator bool() const { return m_entry != nullptr; }
+
+        void reset();
+
+    private:
+        friend class PacketPool;
+        explicit Handle(Entry* entry) : m_entry(entry) {}
+        Entry* m_entry = nullptr;
+    };
+
+    explicit PacketPool(std::size_t reserve = 0);
+    ~PacketPool();
+
+    PacketPool(const PacketPool&) = delete;
+    PacketPool& operator = (const PacketPool&) = delete;
+
+    //returns an empty packet. May be called from any thread, but
+    //all handles must be released before the pool is destroyed
+    Handle acquire();
+
+    //the number of packets ever created, which stops growing once warmed up
+    std::size_t getPacketCount() const;
+
+private:
+    struct Entry final
+    {
+        sf::Packet packet;
+        std::atomic<sf::Uint32> refCount;
+        PacketPool* pool = nullptr;
+    };
+
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<Entry>> m_entries;
+    std::vector<Entry*> m_freeEntries;
+
+    void release(Entry*);
+};
+
+#endif //RM_PACKET_POOL_HPP_
@@ -0,0 +1,108 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+//slot map of connected players used by the server. Players are stored
+//densely for iteration, and looked up either by handle or by client ID
+
+#ifndef RM_PLAYER_REGISTRY_HPP_
+#define RM_PLAYER_REGISTRY_HPP_
+
+#include <xygine/network/Config.hpp>
+
+#include <SFML/Config.hpp>
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace xy
+{
+    class Entity;
+}
+
+struct PlayerHandle final
+{
+    static const sf::Uint16 InvalidIndex = 0xffff;
+
+    sf::Uint16 index = InvalidIndex;
+    sf::Uint16 generation = 0;
+
+    bool valid() const { return index != InvalidIndex; }
+};
+
+class PlayerRegistry final
+{
+public:
+    struct Player final
+    {
+        std::string name;
+        xy::ClientID id = -1;
+        xy::Entity* entity = nullptr;
+        PlayerHandle handle;
+    };
+
+    PlayerRegistry() = default;
+    ~PlayerRegistry() = default;
+
+    PlayerRegistry(const PlayerRegistry&) = delete;
+    PlayerRegistry& operator = (const PlayerRegistry&) = delete;
+
+    //returns an invalid handle if the client ID is already registered
+    PlayerHandle add(const Player&);
+    bool remove(PlayerHandle);
+    bool remove(xy::ClientID);
+    void clear();
+
+    //returned pointers are only valid until the next add/remove
+    Player* get(PlayerHandle);
+    Player* find(xy::ClientID);
+    PlayerHandle getHandle(xy::ClientID) const;
+
+    std::size_t size() const { return m_players.size(); }
+    bool empty() const { return m_players.empty(); }
+
+    std::vector<Player>::iterator begin() { return m_players.begin(); }
+    std::vector<Player>::iterator end() { return m_players.end(); }
+    std::vector<Player>::const_iterator begin() const { return m_players.cbegin(); }
+    std::vector<Player>::const_iterator end() const { return m_players.cend(); }
+
+private:
+    struct Slot final
+    {
+        sf::Uint16 denseIndex = PlayerHandle::InvalidIndex;
+        sf::Uint16 generation = 0;
+    };
+    std::vector<Slot> m_slots;
+    std::vector<sf::Uint16> m_freeSlots;
+
+    std::vector<Player> m_players;
+    std::unordered_map<xy::ClientID, PlayerHandle> m_clientLookup;
+};
+
+#endif //RM_PLAYER_REGISTRY_HPP_
@@ -0,0 +1,76 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+//content addressed store of the programs uploaded to the server. Clients
+//send a digest first and only upload the program if it isn't stored
+
+#ifndef RM_PROGRAM_STORE_HPP_
+#define RM_PROGRAM_STORE_HPP_
+
+#include <SFML/Config.hpp>
+
+#include <vector>
+#include <unordered_map>
+
+class ProgramStore final
+{
+public:
+    using Digest = sf::Uint64;
+    using Program = std::vector<sf::Uint8>;
+
+    static Digest digest(const Program&);
+
+    //least recently used programs are evicted once capacity is reached
+    explicit ProgramStore(std::size_t capacity = 64);
+    ~ProgramStore() = default;
+
+    ProgramStore(const ProgramStore&) = delete;
+    ProgramStore& operator = (const ProgramStore&) = delete;
+
+    //returns nullptr if no program with the digest is stored
+    const Program* find(Digest);
+    //returns false if the program doesn't match the digest, or if a
+    //different program is already stored under it
+    bool insert(Digest, const Program&);
+    void clear();
+
+    std::size_t size() const { return m_programs.size(); }
+
+private:
+    struct Entry final
+    {
+        Program program;
+        sf::Uint32 lastUsed = 0;
+    };
+    std::unordered_map<Digest, Entry> m_programs;
+    std::size_t m_capacity;
+    sf::Uint32 m_useCount;
+};
+
+#endif //RM_PROGRAM_STORE_HPP_
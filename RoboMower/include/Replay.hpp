@@ -0,0 +1,88 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+//file format shared by the replay recorder and player. A replay is a
+//header followed by a stream of events, all stored little endian:
+//
+//header: magic "RMRP", Uint16 version, Uint32 map seed
+//event: Uint8 type, Uint32 time (ms), Int32 client ID, Uint32 tick, Uint16 payload size, payload
+
+#ifndef RM_REPLAY_HPP_
+#define RM_REPLAY_HPP_
+
+#include <xygine/network/Config.hpp>
+
+#include <SFML/Config.hpp>
+
+#include <cstring>
+#include <vector>
+
+namespace Replay
+{
+    static const char Magic[] = { 'R', 'M', 'R', 'P' };
+    static const sf::Uint16 Version = 1;
+    static const std::size_t HeaderSize = 10;
+    static const std::size_t EventHeaderSize = 15;
+
+    enum class EventType : sf::Uint8
+    {
+        PlayerJoined = 0, //payload: float spawn x, float spawn y, name
+        PlayerLeft,
+        Program, //payload: program bytes
+        Transport, //payload: TransportChange
+        StateHash //payload: Uint32 hash
+    };
+
+    struct Event final
+    {
+        EventType type = EventType::PlayerJoined;
+        sf::Uint32 time = 0;
+        xy::ClientID clientID = -1;
+        //the simulation tick of the player's PlayerLogic when the event happened
+        sf::Uint32 tick = 0;
+        std::vector<sf::Uint8> payload;
+    };
+
+    //floats are stored by their bit pattern so they round trip exactly
+    static inline sf::Uint32 floatBits(float value)
+    {
+        sf::Uint32 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    static inline float bitsFloat(sf::Uint32 bits)
+    {
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+}
+
+#endif //RM_REPLAY_HPP_
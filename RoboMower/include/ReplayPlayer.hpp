@@ -0,0 +1,98 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+//plays back sessions recorded by ReplayRecorder. Mower simulations are
+//rebuilt from the recorded programs and transport changes, and checked
+//against the recorded state hashes. Playback can run in real time at
+//any speed, or as fast as possible without rendering
+
+#ifndef RM_REPLAY_PLAYER_HPP_
+#define RM_REPLAY_PLAYER_HPP_
+
+#include <Replay.hpp>
+
+#include <xygine/Scene.hpp>
+#include <xygine/MessageBus.hpp>
+
+#include <map>
+#include <string>
+
+class PlayerLogic;
+
+class ReplayPlayer final
+{
+public:
+    struct Summary final
+    {
+        std::size_t events = 0;
+        std::size_t checkpoints = 0;
+        std::size_t mismatches = 0;
+        sf::Uint32 duration = 0; //ms
+    };
+
+    ReplayPlayer();
+    ~ReplayPlayer() = default;
+
+    ReplayPlayer(const ReplayPlayer&) = delete;
+    ReplayPlayer& operator = (const ReplayPlayer&) = delete;
+
+    //returns false if the file is missing, malformed or from an incompatible version
+    bool load(const std::string& path);
+    sf::Uint32 getMapSeed() const { return m_mapSeed; }
+
+    //multiplier applied to the time passed to update()
+    void setSpeed(float speed) { m_speed = speed; }
+    //plays back events up to the current replay time
+    void update(float);
+    //plays back all remaining events immediately
+    void runToEnd();
+    bool finished() const { return m_nextEvent == m_events.size(); }
+
+    const Summary& getSummary() const { return m_summary; }
+    //contains an entity per player, for rendering
+    xy::Scene& getScene() { return m_scene; }
+
+private:
+    xy::MessageBus m_messageBus;
+    xy::Scene m_scene;
+    std::map<xy::ClientID, xy::Entity*> m_players;
+
+    std::vector<Replay::Event> m_events;
+    std::size_t m_nextEvent;
+    sf::Uint32 m_mapSeed;
+    float m_speed;
+    float m_time;
+    Summary m_summary;
+
+    void apply(const Replay::Event&);
+    void flushMessages();
+    PlayerLogic* getPlayerLogic(xy::ClientID);
+};
+
+#endif //RM_REPLAY_PLAYER_HPP_
@@ -0,0 +1,88 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+//records a server session to disk. Events are appended to a buffer
+//which a background thread streams to the file, so recording never
+//blocks the server on disk access
+
+#ifndef RM_REPLAY_RECORDER_HPP_
+#define RM_REPLAY_RECORDER_HPP_
+
+#include <Replay.hpp>
+#include <PacketEnums.hpp>
+
+#include <SFML/System/Clock.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class ReplayRecorder final
+{
+public:
+    ReplayRecorder();
+    ~ReplayRecorder();
+
+    ReplayRecorder(const ReplayRecorder&) = delete;
+    ReplayRecorder& operator = (const ReplayRecorder&) = delete;
+
+    //creates the file, overwriting any existing one, and starts the writer thread
+    bool open(const std::string& path, sf::Uint32 mapSeed);
+    //writes any remaining events and closes the file
+    void close();
+    bool isOpen() const { return m_running; }
+
+    //these are thread safe, and do nothing if the recorder isn't open
+    void playerJoined(xy::ClientID, const std::string& name, const sf::Vector2f& spawnPosition);
+    void playerLeft(xy::ClientID);
+    void program(xy::ClientID, sf::Uint32 tick, const std::vector<sf::Uint8>&);
+    void transport(xy::ClientID, sf::Uint32 tick, TransportChange);
+    void stateHash(xy::ClientID, sf::Uint32 tick, sf::Uint32 hash);
+
+private:
+    std::ofstream m_file;
+    sf::Clock m_clock;
+
+    //events are appended to one buffer while the other is written
+    std::vector<sf::Uint8> m_buffer;
+    std::vector<sf::Uint8> m_writeBuffer;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::thread m_thread;
+    bool m_running;
+
+    void append(Replay::EventType, xy::ClientID, sf::Uint32 tick, const void* payload, std::size_t size);
+    void threadFunc();
+};
+
+#endif //RM_REPLAY_RECORDER_HPP_
@@ -0,0 +1,118 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+//world state snapshots sent from the server. Snapshots are delta
+//compressed against the most recent one acknowledged by the client
+
+#ifndef RM_SNAPSHOT_HPP_
+#define RM_SNAPSHOT_HPP_
+
+#include <PacketEnums.hpp>
+
+#include <xygine/network/Config.hpp>
+#include <xygine/network/PacketQueue.hpp>
+
+#include <SFML/System/Vector2.hpp>
+
+#include <array>
+#include <vector>
+
+namespace sf
+{
+    class Packet;
+}
+
+struct Snapshot final
+{
+    struct Entry final
+    {
+        //compact index the server gives each player, which is
+        //smaller to send than a client ID and can index arrays
+        sf::Uint16 slot = 0;
+        sf::Vector2f position;
+        Direction direction = Direction::Right;
+    };
+
+    xy::Network::SeqID sequence = 0;
+    std::vector<Entry> entries; //sorted by slot
+
+    void clear() { entries.clear(); }
+    //keeps entries sorted
+    void add(const Entry&);
+    const Entry* find(sf::Uint16 slot) const;
+    bool operator == (const Snapshot&) const;
+    bool operator != (const Snapshot& other) const { return !(*this == other); }
+};
+
+//ring buffer of snapshots indexed by sequence ID
+class SnapshotHistory final
+{
+public:
+    static const std::size_t Size = 32;
+
+    SnapshotHistory();
+
+    void insert(const Snapshot&);
+    //returns nullptr if the sequence has been overwritten or never existed
+    const Snapshot* get(xy::Network::SeqID) const;
+    void clear();
+
+private:
+    std::array<Snapshot, Size> m_snapshots;
+    std::array<bool, Size> m_valid;
+};
+
+namespace SnapshotCodec
+{
+    /*!
+    \brief Rounds positions to the precision they are sent with, so
+    that the server's baselines match what clients reconstruct
+    */
+    void quantise(Snapshot&);
+
+    /*!
+    \brief Writes only the entries of current which differ from baseline.
+    If baseline is nullptr a complete keyframe is written instead.
+    */
+    void write(sf::Packet&, const Snapshot& current, const Snapshot* baseline);
+
+    /*!
+    \brief Reads a snapshot written with write() and rebuilds it from
+    the referenced baseline found in history.
+    \returns false if the baseline is no longer available
+    */
+    bool read(sf::Packet&, const SnapshotHistory& history, Snapshot& dest);
+}
+
+static inline bool sequenceMoreRecent(xy::Network::SeqID a, xy::Network::SeqID b)
+{
+    return xy::Network::moreRecent(a, b, 0xFFFF);
+}
+
+#endif //RM_SNAPSHOT_HPP_
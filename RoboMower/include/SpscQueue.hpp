@@ -0,0 +1,86 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+//lock free queue for passing items from exactly one producer thread
+//to exactly one consumer thread
+
+#ifndef RM_SPSC_QUEUE_HPP_
+#define RM_SPSC_QUEUE_HPP_
+
+#include <array>
+#include <atomic>
+#include <utility>
+
+template <typename T, std::size_t Size>
+class SpscQueue final
+{
+    static_assert(Size > 1 && (Size & (Size - 1)) == 0, "Queue size must be a power of two");
+
+public:
+    SpscQueue() : m_head(0), m_tail(0) {}
+    ~SpscQueue() = default;
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator = (const SpscQueue&) = delete;
+
+    //producer only. Returns false, leaving item untouched, if the queue is full
+    bool push(T& item)
+    {
+        auto tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == Size) return false;
+
+        std::swap(m_items[tail & (Size - 1)], item);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    //consumer only. Returns false if the queue is empty
+    bool pop(T& item)
+    {
+        auto head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) return false;
+
+        std::swap(item, m_items[head & (Size - 1)]);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const
+    {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+private:
+    std::array<T, Size> m_items;
+    //kept on separate cache lines so the two threads don't contend
+    alignas(64) std::atomic<std::size_t> m_head;
+    alignas(64) std::atomic<std::size_t> m_tail;
+};
+
+#endif //RM_SPSC_QUEUE_HPP_
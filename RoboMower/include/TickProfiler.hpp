@@ -0,0 +1,168 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+//lightweight instrumentation for the server tick. Phase timings are kept
+//in log-linear histograms so that percentiles can be read back without
+//storing every sample, and per-client traffic is counted as it is sent.
+//Dumps are formatted on the game thread but written by a background
+//thread, so the tick being measured never waits on the disk
+
+#ifndef RM_TICK_PROFILER_HPP_
+#define RM_TICK_PROFILER_HPP_
+
+#include <xygine/network/Config.hpp>
+
+#include <SFML/System/Clock.hpp>
+
+#include <array>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+//records values in microseconds to within ~6% up to a couple of minutes
+class LatencyHistogram final
+{
+public:
+    LatencyHistogram();
+
+    void record(sf::Uint32 value);
+    void reset();
+
+    //returns the value below which the given fraction (0-1) of samples fall
+    sf::Uint32 getPercentile(float) const;
+    sf::Uint32 getMax() const { return m_max; }
+    float getMean() const;
+    sf::Uint32 getCount() const { return m_count; }
+
+private:
+    static const sf::Uint32 SubBucketBits = 4;
+    static const sf::Uint32 SubBucketCount = 1 << SubBucketBits;
+    static const sf::Uint32 BucketCount = 24;
+
+    std::array<sf::Uint32, (BucketCount + 1) * SubBucketCount> m_counts;
+    sf::Uint32 m_count;
+    sf::Uint32 m_max;
+    sf::Uint64 m_total;
+
+    static std::size_t indexOf(sf::Uint32);
+    static sf::Uint32 valueOf(std::size_t);
+};
+
+class TickProfiler final
+{
+public:
+    enum Phase
+    {
+        Messages,
+        Scene,
+        Connection,
+        Replication,
+        Tick,
+        Count
+    };
+
+    //records the time between construction and destruction
+    class ScopedTimer final
+    {
+    public:
+        ScopedTimer(TickProfiler& profiler, Phase phase) : m_profiler(profiler), m_phase(phase) {}
+        ~ScopedTimer() { m_profiler.record(m_phase, static_cast<sf::Uint32>(m_clock.getElapsedTime().asMicroseconds())); }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator = (const ScopedTimer&) = delete;
+
+    private:
+        TickProfiler& m_profiler;
+        Phase m_phase;
+        sf::Clock m_clock;
+    };
+
+    TickProfiler();
+    ~TickProfiler();
+
+    TickProfiler(const TickProfiler&) = delete;
+    TickProfiler& operator = (const TickProfiler&) = delete;
+
+    /*!
+    \brief Sets the file to which stats are appended every interval seconds.
+    An empty path disables the dump, though stats are still collected.
+    The file is opened here rather than when the first dump is due.
+    */
+    void setOutput(const std::string& path, float interval);
+
+    void record(Phase phase, sf::Uint32 microseconds) { m_histograms[phase].record(microseconds); }
+    void addTraffic(xy::ClientID, std::size_t bytes);
+    void removeClient(xy::ClientID);
+
+    //updates the per-second rates and writes the dump when it's due
+    void update(float);
+
+    const LatencyHistogram& getHistogram(Phase phase) const { return m_histograms[phase]; }
+    //totals since the profiler was created
+    sf::Uint64 getTotalBytes() const { return m_totalBytes; }
+    sf::Uint64 getTotalPackets() const { return m_totalPackets; }
+
+private:
+    std::array<LatencyHistogram, Phase::Count> m_histograms;
+
+    struct Traffic final
+    {
+        sf::Uint64 bytes = 0;
+        sf::Uint32 packets = 0;
+        float bytesPerSecond = 0.f;
+        float packetsPerSecond = 0.f;
+    };
+    std::unordered_map<xy::ClientID, Traffic> m_traffic;
+    sf::Uint64 m_totalBytes;
+    sf::Uint64 m_totalPackets;
+
+    std::string m_outputPath;
+    float m_interval;
+    float m_accumulator;
+    float m_uptime;
+
+    //dumps are appended to one string while the other is written
+    std::ofstream m_file;
+    std::string m_pendingOutput;
+    std::string m_writeOutput;
+    std::mutex m_writeMutex;
+    std::condition_variable m_writeCondition;
+    std::thread m_writeThread;
+    bool m_writing;
+
+    void stopWriting();
+    void writeFunc();
+    void dump();
+    void report();
+};
+
+#endif //RM_TICK_PROFILER_HPP_
@@ -0,0 +1,131 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+//links which use xygine's UDP connections. Packets arrive on the
+//connection's listen thread and are queued until the link is updated,
+//so handlers are always called on the thread which owns the link
+
+#ifndef RM_UDP_LINK_HPP_
+#define RM_UDP_LINK_HPP_
+
+#include <Link.hpp>
+#include <SpscQueue.hpp>
+
+#include <xygine/network/ServerConnection.hpp>
+#include <xygine/network/ClientConnection.hpp>
+
+#include <atomic>
+#include <functional>
+
+//hands received packets from the listen thread to the update thread.
+//Packets are copied into pooled buffers which circulate between the
+//two threads, so nothing is allocated once the pool has warmed up
+class InboundQueue final
+{
+public:
+    static const std::size_t Size = 1024;
+    using Handler = std::function<void(xy::ClientID, xy::Network::PacketType, sf::Packet&)>;
+
+    InboundQueue();
+
+    //listen thread only. Waits for space rather than dropping packets,
+    //as reliable ones will already have been acknowledged
+    void push(xy::ClientID, xy::Network::PacketType, const sf::Packet&);
+    //update thread only
+    void drain(const Handler&);
+    //stops push() waiting, so the listen thread can be joined
+    void close() { m_open = false; }
+    //discards anything left over and starts accepting packets again.
+    //only call this while the listen thread is stopped
+    void reset();
+
+private:
+    struct Item final
+    {
+        xy::ClientID clientID = xy::Network::NullID;
+        xy::Network::PacketType type = xy::Network::HeartBeat;
+        //sf::Packet has no move support, so is held by pointer to make swaps cheap
+        std::unique_ptr<sf::Packet> packet;
+    };
+    SpscQueue<Item, Size> m_queue;
+    Item m_producerItem;
+    Item m_consumerItem;
+    std::atomic<bool> m_open;
+};
+
+class UdpClientLink final : public ClientLink
+{
+public:
+    UdpClientLink(const sf::IpAddress&, xy::PortNumber);
+    ~UdpClientLink();
+
+    UdpClientLink(const UdpClientLink&) = delete;
+    UdpClientLink& operator = (const UdpClientLink&) = delete;
+
+    bool connect() override;
+    void disconnect() override;
+    void update(float) override;
+    bool send(sf::Packet&, bool) override;
+
+    bool connected() const override;
+    xy::ClientID getClientID() const override;
+    sf::Time getTime() const override;
+
+private:
+    //declared first so it outlives the listen thread
+    InboundQueue m_inbound;
+    xy::Network::ClientConnection m_connection;
+};
+
+class UdpServerLink final : public ServerLink
+{
+public:
+    explicit UdpServerLink(xy::MessageBus&);
+    ~UdpServerLink();
+
+    UdpServerLink(const UdpServerLink&) = delete;
+    UdpServerLink& operator = (const UdpServerLink&) = delete;
+
+    bool start() override;
+    void stop() override;
+    void update(float) override;
+    bool send(xy::ClientID, sf::Packet&, bool) override;
+    void broadcast(sf::Packet&, bool) override;
+    void setMaxClients(std::size_t) override;
+
+    //connects to this server via the local network interface
+    std::unique_ptr<ClientLink> createLocalClient() override;
+
+private:
+    //declared first so it outlives the listen thread
+    InboundQueue m_inbound;
+    xy::Network::ServerConnection m_connection;
+};
+
+#endif //RM_UDP_LINK_HPP_
@@ -0,0 +1,130 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+//grass clippings thrown out by every mower on the lawn. All particles
+//share one pool, stored as separate arrays of floats so updating them
+//is a handful of tight loops, and are drawn with a single vertex array
+
+#ifndef RM_CLIPPING_PARTICLES_HPP_
+#define RM_CLIPPING_PARTICLES_HPP_
+
+#include <PacketEnums.hpp>
+#include <AssetManager.hpp>
+
+#include <xygine/components/Component.hpp>
+
+#include <SFML/Graphics/Drawable.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/BlendMode.hpp>
+
+#include <array>
+#include <vector>
+
+namespace sf
+{
+    class Texture;
+}
+
+class PlayerDrawable;
+class ClippingParticles final : public xy::Component, public sf::Drawable
+{
+public:
+    static const std::size_t DefaultBudget = 2048;
+
+    ClippingParticles(xy::MessageBus&, AssetManager::Lease&);
+    ~ClippingParticles() = default;
+
+    xy::Component::Type type() const override { return xy::Component::Type::Drawable; }
+    void entityUpdate(xy::Entity&, float) override;
+
+    //mowers emit clippings in proportion to the number of tiles they
+    //move across. Mowers must be in the same space as this entity
+    void addMower(xy::Entity&);
+    void removeMower(const xy::Entity&);
+
+    //the most particles alive at once. Emission is thinned out as the
+    //pool fills, rather than stopping dead when it's full
+    void setBudget(std::size_t);
+    std::size_t getParticleCount() const { return m_count; }
+
+    void clear();
+
+private:
+    //emission settings for each direction, taken from the xyp files
+    struct Style final
+    {
+        std::vector<sf::Vector2f> velocities;
+        std::vector<sf::Vector2f> positions;
+        sf::Vector2f drag;
+        sf::Vector2f size;
+        sf::Color colour;
+        float lifetime = 0.5f;
+        float particlesPerTile = 0.f;
+    };
+    std::array<Style, static_cast<std::size_t>(Direction::Count)> m_styles;
+    const sf::Texture* m_texture;
+    sf::BlendMode m_blendMode;
+
+    struct Mower final
+    {
+        const xy::Entity* entity = nullptr;
+        const PlayerDrawable* drawable = nullptr;
+        sf::Vector2f lastPosition;
+        float pending = 0.f;
+    };
+    std::vector<Mower> m_mowers;
+
+    std::vector<float> m_positionX;
+    std::vector<float> m_positionY;
+    std::vector<float> m_velocityX;
+    std::vector<float> m_velocityY;
+    std::vector<float> m_dragX;
+    std::vector<float> m_dragY;
+    std::vector<float> m_life;
+    std::vector<float> m_age;
+    std::vector<float> m_invLifetime;
+    std::vector<float> m_halfWidth;
+    std::vector<float> m_halfHeight;
+    std::vector<sf::Color> m_colours;
+    std::size_t m_count;
+    std::size_t m_budget;
+
+    std::vector<sf::Vertex> m_vertices;
+
+    void emit(Mower&, float lod);
+    void spawn(const Style&, const sf::Vector2f&, float sizeScale);
+    void integrate(float dt);
+    void removeDead();
+    void updateVertices();
+
+    void draw(sf::RenderTarget&, sf::RenderStates) const override;
+};
+
+#endif //RM_CLIPPING_PARTICLES_HPP_
@@ -30,23 +30,81 @@ source distribution.
 #ifndef RM_NETWORK_CONTROLLER_HPP_
 #define RM_NETWORK_CONTROLLER_HPP_
 
+#include <PacketEnums.hpp>
+
 #include <xygine/components/Component.hpp>
 
+#include <array>
+
+//maps the server time updates were sent at onto the client link's
+//clock, and decides how far behind that remote entities are drawn.
+//One clock is shared by every NetworkController
+class InterpolationClock final
+{
+public:
+    InterpolationClock();
+
+    //localTime is the link's time when the update arrived
+    void addSample(float serverTime, float localTime);
+    void update(float localTime, float dt);
+
+    //the smallest delay. Slow update rates are given more
+    void setDelay(float delay) { m_minDelay = delay; }
+    float getDelay() const { return m_delay; }
+    //average time between updates
+    float getInterval() const { return m_interval; }
+
+    //the server time to draw remote entities at
+    float getRenderTime() const { return m_renderTime; }
+
+private:
+    //the fastest any update has taken to arrive, which includes the
+    //difference between the server's clock and the link's
+    float m_offset;
+    bool m_hasOffset;
+
+    float m_lastServerTime;
+    float m_interval;
+
+    float m_minDelay;
+    float m_delay;
+    float m_renderTime;
+};
+
 class NetworkController final : public xy::Component
 {
 public:
-    explicit NetworkController(xy::MessageBus&);
+    NetworkController(xy::MessageBus&, const InterpolationClock&);
     ~NetworkController() = default;
 
     xy::Component::Type type() const override { return xy::Component::Type::Script; }
     void entityUpdate(xy::Entity&, float) override;
 
-    void setDestination(const sf::Vector2f&);
+    //position of the entity at the given server time
+    void addSample(float serverTime, const sf::Vector2f& position);
+    //forgets all samples so the component can be reused
+    void reset();
+    //faster playback moves further between updates, so needs a larger snap distance
+    void setSpeed(TransportSpeed speed) { m_speed = speed; }
+    TransportSpeed getSpeed() const { return m_speed; }
 
 private:
-
-    sf::Vector2f m_destination;
-
+    const InterpolationClock& m_clock;
+
+    struct Sample final
+    {
+        float time = 0.f;
+        sf::Vector2f position;
+    };
+    //sorted oldest first. Entities are left alone until there's a sample
+    std::array<Sample, 16> m_samples;
+    std::size_t m_sampleCount;
+
+    TransportSpeed m_speed;
+
+    void insert(const Sample&);
+    void pop();
+    sf::Vector2f getPosition(float time) const;
 };
 
 #endif // RM_NETWORK_CONTROLLER_HPP_
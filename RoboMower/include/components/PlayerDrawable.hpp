@@ -39,15 +39,17 @@ source distribution.
 
 #include <vector>
 
+struct TileSet;
 class PlayerDrawable final : public xy::Component, public sf::Drawable, public sf::Transformable
 {
 public:
-    PlayerDrawable(xy::MessageBus&, sf::Texture&, bool local);
+    PlayerDrawable(xy::MessageBus&, sf::Texture&, const TileSet&, bool local);
     PlayerDrawable() = default;
 
     xy::Component::Type type() const override { return xy::Component::Type::Drawable; }
     void entityUpdate(xy::Entity&, float) override;
     void setDirection(Direction);
+    Direction getDirection() const { return m_direction; }
 
 private:
 
@@ -64,7 +66,7 @@ private:
     
     std::size_t m_jiggleIndex;
 
-    void createSprites(bool local);
+    void createSprites(const TileSet&, bool local);
     void buildSprite(const sf::Vector2f&, const sf::Vector2f&, Direction);
     void draw(sf::RenderTarget&, sf::RenderStates) const override;
 };
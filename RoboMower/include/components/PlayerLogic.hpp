@@ -31,15 +31,46 @@ source distribution.
 #define RM_PLAYER_LOGIC_HPP_
 
 #include <PacketEnums.hpp>
+#include <InstructionSet.hpp>
 
 #include <xygine/components/Component.hpp>
 #include <xygine/network/Config.hpp>
 
-#include <SFML/System/Clock.hpp>
+#include <SFML/System/Time.hpp>
 
+#include <array>
+#include <functional>
+#include <map>
+
+//runs a mower program in fixed time steps so that the same program
+//produces the same result on the server and on every client
 class PlayerLogic final : public xy::Component
 {
 public:
+    //everything needed to resume the simulation from a given tick
+    struct State final
+    {
+        sf::Uint32 tick = 0;
+        sf::Vector2f position;
+        sf::Vector2f target;
+        Direction direction = Direction::Right;
+        TransportStatus transportStatus = TransportStatus::Stopped;
+        sf::Uint16 programCounter = 0;
+        sf::Uint16 loopDestination = 0;
+        sf::Int8 loopCounter = 0;
+        sf::Uint8 currentParameter = 0;
+        sf::Uint8 currentInstruction = Instruction::NOP;
+        float rotationTime = 0.f;
+    };
+
+    enum class Checkpoint
+    {
+        Match,
+        Mismatch,
+        Pending,
+        Expired
+    };
+
     PlayerLogic(xy::MessageBus&, const sf::Vector2f&);
     ~PlayerLogic() = default;
 
@@ -49,10 +80,34 @@ public:
 
     void setClientID(xy::ClientID);
     void setProgram(const std::vector<sf::Uint8>& program) { m_program = program; }
+    const std::vector<sf::Uint8>& getProgram() const { return m_program; }
+    Direction getDirection() const { return m_currentDirection; }
+    TransportStatus getTransportStatus() const { return m_transportStatus; }
+    sf::Uint32 getTick() const { return m_tick; }
 
     void start();
     void pause();
     void rewind();
+    //returns to the state of a newly created mower so the component can be reused
+    void reset(const sf::Vector2f& spawnPosition);
+
+    void setSpeed(TransportSpeed speed) { m_speed = speed; }
+    TransportSpeed getSpeed() const { return m_speed; }
+    //how long each update may spend stepping when running at TransportSpeed::Max
+    void setStepBudget(sf::Time budget) { m_stepBudget = budget; }
+
+    //steps the simulation without waiting for real time to pass
+    void advanceTo(sf::Uint32 tick);
+
+    State getState() const;
+    void setState(const State&);
+    sf::Uint32 getStateHash() const;
+
+    //compares a state hash from the server against the local simulation.
+    //checkpoints for ticks not yet reached are checked once they are.
+    //Expired means the tick has fallen out of the history, so can't be checked
+    Checkpoint verify(sf::Uint32 tick, sf::Uint32 hash);
+    bool desynchronised() const { return m_desynchronised; }
 
 private:
     xy::Entity* m_entity;
@@ -60,7 +115,7 @@ private:
     xy::ClientID m_clientID;
     Direction m_currentDirection;
     sf::Vector2f m_target;
-    sf::Clock m_rotationTimer;
+    float m_rotationTime;
 
     TransportStatus m_transportStatus;
     std::vector<sf::Uint8> m_program;
@@ -69,9 +124,26 @@ private:
     sf::Int8 m_loopCounter;
 
     sf::Uint8 m_currentParameter;
+    Instruction m_currentInstruction;
     std::function<bool(xy::Entity&, float)> m_currentAction;
+    std::map<Instruction, std::function<bool(xy::Entity&, float)>> m_instructions;
+
+    sf::Uint32 m_tick;
+    float m_accumulator;
+    TransportSpeed m_speed;
+    sf::Time m_stepBudget;
 
+    //covers a client running a second ahead of the server at octuple speed
+    std::array<std::pair<sf::Uint32, sf::Uint32>, 512u> m_hashHistory;
+    std::vector<std::pair<sf::Uint32, sf::Uint32>> m_pendingCheckpoints;
+    bool m_desynchronised;
+
+    void step(xy::Entity&);
+    void clearHistory();
     void stop();
 };
 
+sf::Packet& operator << (sf::Packet&, const PlayerLogic::State&);
+sf::Packet& operator >> (sf::Packet&, PlayerLogic::State&);
+
 #endif //RM_PLAYER_LOGIC_HPP_
\ No newline at end of file
@@ -36,15 +36,12 @@ source distribution.
 
 #include <vector>
 
-namespace picojson
-{
-    class value;
-}
+struct TileSet;
 
 class Tilemap final : public xy::Component, public sf::Drawable
 {
 public:
-    Tilemap(xy::MessageBus&, sf::Texture&);
+    Tilemap(xy::MessageBus&, sf::Texture&, const TileSet&);
     ~Tilemap() = default;
 
     xy::Component::Type type() const override { return xy::Component::Type::Drawable; }
@@ -92,8 +89,7 @@ private:
     std::vector<sf::Vertex> m_lawnArray;
 
 
-    void loadJson();
-    void getValue(const std::string&, const picojson::value&, Tilemap::Tile);
+    void loadTiles(const TileSet&);
     
     void buildMap();
     void addTile(float x, float y, Tile, std::vector<sf::Vertex>&);
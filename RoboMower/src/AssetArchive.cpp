@@ -0,0 +1,241 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+#include <AssetArchive.hpp>
+
+#include <xygine/Log.hpp>
+
+#include <cstring>
+
+#ifdef RM_USE_LZ4
+#include <lz4.h>
+#endif //RM_USE_LZ4
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif //NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif //_WIN32
+
+namespace
+{
+    //path length, flags, offset, stored size and size
+    const std::size_t MinEntrySize = 2 + 1 + 8 + 8 + 8;
+
+    //reads little endian integers from the index without assuming alignment
+    template <typename T>
+    bool readValue(const char*& pos, const char* end, T& dest)
+    {
+        if (static_cast<std::size_t>(end - pos) < sizeof(T)) return false;
+
+        dest = 0;
+        for (auto i = 0u; i < sizeof(T); ++i)
+        {
+            dest |= static_cast<T>(static_cast<sf::Uint8>(pos[i])) << (i * 8);
+        }
+        pos += sizeof(T);
+        return true;
+    }
+}
+
+AssetArchive::AssetArchive()
+    : m_data    (nullptr),
+    m_size      (0),
+    m_file      (nullptr),
+    m_mapping   (nullptr)
+{
+
+}
+
+AssetArchive::~AssetArchive()
+{
+    close();
+}
+
+//public
+bool AssetArchive::open(const std::string& path)
+{
+    close();
+
+#ifdef _WIN32
+    auto file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    m_file = file;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        close();
+        return false;
+    }
+
+    m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping)
+    {
+        close();
+        return false;
+    }
+    m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    m_size = static_cast<std::size_t>(size.QuadPart);
+#else
+    auto file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) return false;
+
+    struct stat info;
+    if (fstat(file, &info) != 0 || info.st_size == 0)
+    {
+        ::close(file);
+        return false;
+    }
+
+    auto data = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    //the mapping holds its own reference to the file
+    ::close(file);
+    if (data == MAP_FAILED) return false;
+
+    m_data = static_cast<const char*>(data);
+    m_size = static_cast<std::size_t>(info.st_size);
+#endif //_WIN32
+
+    if (!m_data || !readIndex())
+    {
+        xy::Logger::log(path + ": not a valid asset archive", xy::Logger::Type::Error, xy::Logger::Output::All);
+        close();
+        return false;
+    }
+    return true;
+}
+
+void AssetArchive::close()
+{
+#ifdef _WIN32
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mapping) CloseHandle(m_mapping);
+    if (m_file) CloseHandle(m_file);
+#else
+    if (m_data) munmap(const_cast<char*>(m_data), m_size);
+#endif //_WIN32
+
+    m_data = nullptr;
+    m_size = 0;
+    m_file = nullptr;
+    m_mapping = nullptr;
+    m_entries.clear();
+}
+
+bool AssetArchive::contains(const std::string& path) const
+{
+    return m_entries.count(path) != 0;
+}
+
+AssetArchive::View AssetArchive::read(const std::string& path, std::vector<char>& buffer) const
+{
+    View view;
+    auto result = m_entries.find(path);
+    if (result == m_entries.end()) return view;
+
+    const auto& entry = result->second;
+    if ((entry.flags & Flags::Compressed) == 0)
+    {
+        view.data = m_data + entry.offset;
+        view.size = static_cast<std::size_t>(entry.size);
+        return view;
+    }
+
+#ifdef RM_USE_LZ4
+    buffer.resize(static_cast<std::size_t>(entry.size));
+    auto size = LZ4_decompress_safe(m_data + entry.offset, buffer.data(),
+        static_cast<int>(entry.storedSize), static_cast<int>(entry.size));
+    if (size >= 0 && static_cast<sf::Uint64>(size) == entry.size)
+    {
+        view.data = buffer.data();
+        view.size = buffer.size();
+    }
+#endif //RM_USE_LZ4
+    return view;
+}
+
+bool AssetArchive::compressionAvailable()
+{
+#ifdef RM_USE_LZ4
+    return true;
+#else
+    return false;
+#endif //RM_USE_LZ4
+}
+
+//private
+bool AssetArchive::readIndex()
+{
+    if (m_size < HeaderSize || std::memcmp(m_data, "RMPK", 4) != 0) return false;
+
+    const char* pos = m_data + 4;
+    const char* end = m_data + m_size;
+    sf::Uint32 version = 0, count = 0, indexSize = 0;
+    if (!readValue(pos, end, version) || version != Version
+        || !readValue(pos, end, count)
+        || !readValue(pos, end, indexSize)
+        || indexSize > m_size - HeaderSize
+        || count > indexSize / MinEntrySize)
+    {
+        return false;
+    }
+
+    end = pos + indexSize;
+    m_entries.reserve(count);
+    for (auto i = 0u; i < count; ++i)
+    {
+        sf::Uint16 length = 0;
+        if (!readValue(pos, end, length) || static_cast<std::size_t>(end - pos) < length) return false;
+        std::string path(pos, length);
+        pos += length;
+
+        Entry entry;
+        if (!readValue(pos, end, entry.flags)
+            || !readValue(pos, end, entry.offset)
+            || !readValue(pos, end, entry.storedSize)
+            || !readValue(pos, end, entry.size))
+        {
+            return false;
+        }
+
+        //a corrupt index mustn't let reads run off the end of the mapping
+        if (entry.offset > m_size || entry.storedSize > m_size - entry.offset) return false;
+        if ((entry.flags & Flags::Compressed) == 0 && entry.size != entry.storedSize) return false;
+
+        m_entries[path] = entry;
+    }
+    return true;
+}
@@ -0,0 +1,517 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+#include <AssetManager.hpp>
+
+#include <xygine/Log.hpp>
+#include <xygine/parsers/picojson.h>
+
+#include <SFML/Graphics/Image.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <limits>
+
+namespace
+{
+    template <typename T>
+    bool readFile(const std::string& path, T& dest)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.good()) return false;
+
+        dest.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    std::size_t fileSize(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        return file.good() ? static_cast<std::size_t>(file.tellg()) : 0;
+    }
+
+    void logError(const std::string& message)
+    {
+        //always write this, and write to log file so we can see this in release builds
+        xy::Logger::log(message, xy::Logger::Type::Error, xy::Logger::Output::All);
+    }
+}
+
+AssetManager::AssetManager(const std::string& manifestPath, const std::string& archivePath)
+    : m_budget      (DefaultBudget),
+    m_residentSize  (0),
+    m_useCounter    (0),
+    m_fallbackFont  (nullptr)
+{
+    if (!archivePath.empty() && !m_archive.open(archivePath))
+    {
+        xy::Logger::log("no asset archive at " + archivePath + ", using loose files", xy::Logger::Type::Info);
+    }
+    loadManifest(manifestPath);
+}
+
+//public
+void AssetManager::prefetch(const std::string& name)
+{
+    auto group = m_groups.find(name);
+    if (group == m_groups.end())
+    {
+        logError("asset group " + name + " is not in the asset manifest");
+        return;
+    }
+
+    startDecoding(m_textures, m_pendingImages, group->second.textures, &AssetManager::decodeImage);
+    startDecoding(m_fonts, m_pendingFonts, group->second.fonts, &AssetManager::readFont);
+    startDecoding(m_tileSets, m_pendingTileSets, group->second.tileSets, &AssetManager::parseTileSet);
+}
+
+void AssetManager::setBudget(std::size_t bytes)
+{
+    m_budget = bytes;
+    evict(m_budget);
+}
+
+void AssetManager::evictUnused()
+{
+    evict(0);
+}
+
+//private
+void AssetManager::loadManifest(const std::string& path)
+{
+    FileData file;
+    if (!readAsset(path, file))
+    {
+        logError("failed to open asset manifest " + path);
+        return;
+    }
+
+    picojson::value rootValue;
+    std::string err;
+    picojson::parse(rootValue, file.data, file.data + file.size, &err);
+    if (!err.empty() || !rootValue.is<picojson::object>())
+    {
+        logError("asset manifest: " + err);
+        return;
+    }
+
+    auto addEntries = [&rootValue](const std::string& section, auto& dest)
+    {
+        if (!rootValue.get(section).is<picojson::object>()) return;
+
+        const auto& assets = rootValue.get(section).get<picojson::object>();
+        for (const auto& asset : assets)
+        {
+            if (asset.second.is<std::string>())
+            {
+                dest[asset.first].path = asset.second.get<std::string>();
+            }
+        }
+    };
+    addEntries("textures", m_textures);
+    addEntries("fonts", m_fonts);
+    addEntries("tilesets", m_tileSets);
+    addEntries("particles", m_particles);
+
+    if (!rootValue.get("groups").is<picojson::object>()) return;
+
+    auto getIDs = [](const picojson::value& group, const std::string& section, std::vector<std::string>& dest)
+    {
+        if (!group.get(section).is<picojson::array>()) return;
+
+        for (const auto& id : group.get(section).get<picojson::array>())
+        {
+            if (id.is<std::string>()) dest.push_back(id.get<std::string>());
+        }
+    };
+    for (const auto& group : rootValue.get("groups").get<picojson::object>())
+    {
+        auto& dest = m_groups[group.first];
+        getIDs(group.second, "textures", dest.textures);
+        getIDs(group.second, "fonts", dest.fonts);
+        getIDs(group.second, "tilesets", dest.tileSets);
+    }
+}
+
+bool AssetManager::readAsset(const std::string& path, FileData& dest) const
+{
+    if (m_archive.isOpen())
+    {
+        auto view = m_archive.read(path, dest.buffer);
+        if (view.valid())
+        {
+            dest.data = view.data;
+            dest.size = view.size;
+            return true;
+        }
+    }
+
+    if (!readFile(path, dest.buffer)) return false;
+    dest.data = dest.buffer.data();
+    dest.size = dest.buffer.size();
+    return true;
+}
+
+AssetManager::Entry<sf::Texture>& AssetManager::getTextureEntry(const std::string& id)
+{
+    auto& entry = find(m_textures, id, "texture");
+    if (!entry.loaded)
+    {
+        auto image = finishDecoding(m_pendingImages, id, entry.path, &AssetManager::decodeImage);
+        auto texture = std::make_unique<sf::Texture>();
+        if (image.asset && texture->loadFromImage(*image.asset))
+        {
+            entry.asset = std::move(texture);
+            loaded(entry, entry.asset->getSize().x * entry.asset->getSize().y * 4);
+        }
+        else
+        {
+            logError(image.error.empty() ? "failed to create texture " + entry.path : image.error);
+            loaded(entry, 0);
+        }
+    }
+    return entry;
+}
+
+AssetManager::Entry<sf::Font>& AssetManager::getFontEntry(const std::string& id)
+{
+    auto& entry = find(m_fonts, id, "font");
+    if (!entry.loaded && entry.path.empty())
+    {
+        //fonts without a path use xygine's built in font
+        loaded(entry, 0);
+    }
+    else if (!entry.loaded)
+    {
+        auto file = finishDecoding(m_pendingFonts, id, entry.path, &AssetManager::readFont);
+        auto font = std::make_unique<sf::Font>();
+        if (file.asset && font->loadFromMemory(file.asset->data, file.asset->size))
+        {
+            //moving the buffer keeps its data where it is, and fonts
+            //stored uncompressed in the archive are read straight from it
+            entry.memory = std::move(file.asset->buffer);
+            entry.asset = std::move(font);
+            loaded(entry, file.asset->size);
+        }
+        else
+        {
+            logError(file.error.empty() ? "failed to load font " + entry.path : file.error);
+            loaded(entry, 0);
+        }
+    }
+    return entry;
+}
+
+AssetManager::Entry<TileSet>& AssetManager::getTileSetEntry(const std::string& id)
+{
+    auto& entry = find(m_tileSets, id, "tile set");
+    if (!entry.loaded)
+    {
+        auto tileSet = finishDecoding(m_pendingTileSets, id, entry.path, &AssetManager::parseTileSet);
+        if (!tileSet.error.empty()) logError(tileSet.error);
+
+        entry.asset = std::move(tileSet.asset);
+        //roughly the parsed size, each name being a short string
+        loaded(entry, entry.asset ? entry.asset->positions.size() * 64 : 0);
+    }
+    return entry;
+}
+
+AssetManager::Entry<xy::ParticleSystem::Definition>& AssetManager::getParticleEntry(const std::string& id)
+{
+    auto& entry = find(m_particles, id, "particle system");
+    if (!entry.loaded)
+    {
+        //definitions are left unchanged if they fail to load, so
+        //check the file is there to know whether to use the fallback.
+        //xygine can only load these from a file, so they're never archived
+        auto size = fileSize(entry.path);
+        if (size > 0)
+        {
+            entry.asset = std::make_unique<xy::ParticleSystem::Definition>();
+            entry.asset->loadFromFile(entry.path, m_textureResource);
+        }
+        else
+        {
+            logError("failed to open particle system " + entry.path);
+        }
+        loaded(entry, size);
+    }
+    return entry;
+}
+
+AssetManager::Decoded<sf::Image> AssetManager::decodeImage(const std::string& path) const
+{
+    Decoded<sf::Image> result;
+    FileData file;
+    result.asset = std::make_unique<sf::Image>();
+    if (!readAsset(path, file) || !result.asset->loadFromMemory(file.data, file.size))
+    {
+        result.asset.reset();
+        result.error = "failed to load texture " + path;
+    }
+    return result;
+}
+
+AssetManager::Decoded<AssetManager::FileData> AssetManager::readFont(const std::string& path) const
+{
+    Decoded<FileData> result;
+    result.asset = std::make_unique<FileData>();
+    if (!readAsset(path, *result.asset) || result.asset->size == 0)
+    {
+        result.asset.reset();
+        result.error = "failed to load font " + path;
+    }
+    return result;
+}
+
+AssetManager::Decoded<TileSet> AssetManager::parseTileSet(const std::string& path) const
+{
+    Decoded<TileSet> result;
+    FileData file;
+    if (!readAsset(path, file))
+    {
+        result.error = "failed to open tileset data file " + path;
+        return result;
+    }
+    if (file.size == 0)
+    {
+        result.error = "tileset data file is empty";
+        return result;
+    }
+
+    picojson::value rootValue;
+    std::string err;
+    picojson::parse(rootValue, file.data, file.data + file.size, &err);
+    if (!err.empty() || !rootValue.is<picojson::object>())
+    {
+        result.error = "tileset data: " + err;
+        return result;
+    }
+
+    result.asset = std::make_unique<TileSet>();
+    for (const auto& value : rootValue.get<picojson::object>())
+    {
+        if (!value.second.is<picojson::array>()) continue;
+
+        const auto& arr = value.second.get<picojson::array>();
+        if (arr.size() < 2) continue;
+        result.asset->positions[value.first] = sf::Vector2f
+            (
+                arr[0].is<double>() ? static_cast<float>(arr[0].get<double>()) : 0.f,
+                arr[1].is<double>() ? static_cast<float>(arr[1].get<double>()) : 0.f
+            );
+    }
+    return result;
+}
+
+template <typename T, typename U>
+void AssetManager::startDecoding(std::unordered_map<std::string, Entry<T>>& assets, std::unordered_map<std::string, std::future<Decoded<U>>>& pending,
+    const std::vector<std::string>& ids, Decoded<U>(AssetManager::*decode)(const std::string&) const)
+{
+    for (const auto& id : ids)
+    {
+        auto entry = assets.find(id);
+        if (entry == assets.end() || entry->second.loaded || pending.count(id)) continue;
+
+        //each asset gets its own task. There are only a handful per group,
+        //and they spend most of their time waiting on the disk
+        pending[id] = std::async(std::launch::async, decode, this, entry->second.path);
+    }
+}
+
+template <typename U>
+AssetManager::Decoded<U> AssetManager::finishDecoding(std::unordered_map<std::string, std::future<Decoded<U>>>& pending, const std::string& id,
+    const std::string& path, Decoded<U>(AssetManager::*decode)(const std::string&) const)
+{
+    auto result = pending.find(id);
+    if (result == pending.end()) return (this->*decode)(path);
+
+    auto decoded = result->second.get();
+    pending.erase(result);
+    return decoded;
+}
+
+template <typename T>
+AssetManager::Entry<T>& AssetManager::find(std::unordered_map<std::string, Entry<T>>& assets, const std::string& id, const char* type)
+{
+    auto result = assets.find(id);
+    if (result == assets.end())
+    {
+        //remembered as a failed load so the error is only logged once
+        logError(std::string(type) + " " + id + " is not in the asset manifest");
+        auto& entry = assets[id];
+        entry.loaded = true;
+        return entry;
+    }
+    result->second.lastUsed = ++m_useCounter;
+    return result->second;
+}
+
+template <typename T>
+void AssetManager::loaded(Entry<T>& entry, std::size_t size)
+{
+    entry.loaded = true;
+    entry.size = size;
+    m_residentSize += size;
+    //make room for the new asset, which is the most recently used so won't go itself
+    evict(m_budget);
+}
+
+template <typename T>
+void AssetManager::findOldest(std::unordered_map<std::string, Entry<T>>& assets, sf::Uint64& oldest) const
+{
+    for (const auto& asset : assets)
+    {
+        const auto& entry = asset.second;
+        if (entry.asset && entry.refCount == 0
+            && entry.lastUsed != m_useCounter
+            && entry.lastUsed < oldest)
+        {
+            oldest = entry.lastUsed;
+        }
+    }
+}
+
+template <typename T>
+bool AssetManager::evict(std::unordered_map<std::string, Entry<T>>& assets, sf::Uint64 lastUsed)
+{
+    for (auto& asset : assets)
+    {
+        auto& entry = asset.second;
+        if (entry.asset && entry.lastUsed == lastUsed)
+        {
+            entry.asset.reset();
+            entry.memory.clear();
+            entry.memory.shrink_to_fit();
+            entry.loaded = false;
+            m_residentSize -= entry.size;
+            entry.size = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+void AssetManager::evict(std::size_t budget)
+{
+    while (m_residentSize > budget)
+    {
+        //use counts are unique, so the oldest identifies a single asset
+        auto oldest = std::numeric_limits<sf::Uint64>::max();
+        findOldest(m_textures, oldest);
+        findOldest(m_fonts, oldest);
+        findOldest(m_tileSets, oldest);
+        findOldest(m_particles, oldest);
+
+        if (oldest == std::numeric_limits<sf::Uint64>::max()) break; //everything left is in use
+
+        evict(m_textures, oldest)
+            || evict(m_fonts, oldest)
+            || evict(m_tileSets, oldest)
+            || evict(m_particles, oldest);
+    }
+}
+
+sf::Texture& AssetManager::getFallbackTexture()
+{
+    if (!m_fallbackTexture)
+    {
+        sf::Image image;
+        image.create(20u, 20u, sf::Color::Black);
+        m_fallbackTexture = std::make_unique<sf::Texture>();
+        m_fallbackTexture->loadFromImage(image);
+    }
+    return *m_fallbackTexture;
+}
+
+//---------------------------------------------------------
+AssetManager::Lease::Lease(AssetManager& manager)
+    : m_manager(manager)
+{
+
+}
+
+AssetManager::Lease::Lease(AssetManager& manager, const std::string& group)
+    : m_manager(manager)
+{
+    m_manager.prefetch(group);
+}
+
+AssetManager::Lease::~Lease()
+{
+    //assets are only evicted when something else is loaded,
+    //so anything still pointing at them is safe until then
+    for (auto refCount : m_refCounts) (*refCount)--;
+}
+
+//public
+sf::Texture& AssetManager::Lease::getTexture(const std::string& id)
+{
+    auto& entry = m_manager.getTextureEntry(id);
+    acquire(entry);
+    return entry.asset ? *entry.asset : m_manager.getFallbackTexture();
+}
+
+sf::Font& AssetManager::Lease::getFont(const std::string& id)
+{
+    auto& entry = m_manager.getFontEntry(id);
+    acquire(entry);
+    if (entry.asset) return *entry.asset;
+
+    //xygine's fallback font is built in, and must only be created once
+    if (!m_manager.m_fallbackFont) m_manager.m_fallbackFont = &m_manager.m_fontResource.get("");
+    return *m_manager.m_fallbackFont;
+}
+
+const TileSet& AssetManager::Lease::getTileSet(const std::string& id)
+{
+    auto& entry = m_manager.getTileSetEntry(id);
+    acquire(entry);
+    return entry.asset ? *entry.asset : m_manager.m_fallbackTileSet;
+}
+
+const xy::ParticleSystem::Definition& AssetManager::Lease::getParticles(const std::string& id)
+{
+    auto& entry = m_manager.getParticleEntry(id);
+    acquire(entry);
+    return entry.asset ? *entry.asset : m_manager.m_fallbackParticles;
+}
+
+//private
+template <typename T>
+void AssetManager::Lease::acquire(Entry<T>& entry)
+{
+    if (std::find(m_refCounts.begin(), m_refCounts.end(), &entry.refCount) == m_refCounts.end())
+    {
+        entry.refCount++;
+        m_refCounts.push_back(&entry.refCount);
+    }
+}
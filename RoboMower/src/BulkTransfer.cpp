@@ -0,0 +1,337 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+#include <BulkTransfer.hpp>
+#include <NetProtocol.hpp>
+
+#include <xygine/Log.hpp>
+#include <xygine/Assert.hpp>
+
+#include <algorithm>
+
+namespace
+{
+    //how often the receiver reports missing fragments
+    const float statusInterval = 0.1f;
+    //minimum time before the same fragment is sent again
+    const float resendInterval = 0.2f;
+    //the sender resends everything unacknowledged if the receiver goes quiet this long
+    const float silenceInterval = 0.5f;
+    //transfers are abandoned if they make no progress for this long
+    const float transferTimeout = 10.f;
+    //limits how many fragments are sent each update so large transfers don't flood the link
+    const std::size_t fragmentsPerUpdate = 16;
+
+    std::size_t fragmentLength(std::size_t index, std::size_t totalSize)
+    {
+        //copied so that std::min doesn't need the constant to be defined out of line
+        const std::size_t fragmentSize = BulkTransfer::FragmentSize;
+        return std::min(fragmentSize, totalSize - (index * fragmentSize));
+    }
+}
+
+BulkTransfer::BulkTransfer()
+    : m_nextTransferID  (1),
+    m_completedIndex    (0),
+    m_clientID          (-1)
+{
+    m_completed.fill(0);
+}
+
+//public
+bool BulkTransfer::send(BulkChannel channel, const std::vector<sf::Uint8>& data)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (data.empty() || data.size() > MaxSize
+        || m_outgoing.size() >= MaxTransfers)
+    {
+        return false;
+    }
+
+    Outgoing transfer;
+    transfer.id = m_nextTransferID++;
+    if (m_nextTransferID == 0) m_nextTransferID = 1; //0 marks an empty completed slot
+    transfer.channel = channel;
+    transfer.data = data;
+
+    auto count = (data.size() + FragmentSize - 1) / FragmentSize;
+    transfer.acked.resize(count, false);
+    transfer.sendTimes.resize(count, 0.f);
+    m_outgoing.push_back(std::move(transfer));
+    return true;
+}
+
+void BulkTransfer::handlePacket(xy::PacketID ident, sf::Packet& packet)
+{
+    std::vector<std::pair<BulkChannel, std::vector<sf::Uint8>>> completed;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (ident == PacketIdent::Fragment)
+        {
+            handleFragment(packet, completed);
+        }
+        else if (ident == PacketIdent::FragmentStatus)
+        {
+            handleStatus(packet);
+        }
+    }
+
+    //handlers are called without the lock held so they're free to send more data
+    if (m_receiveHandler)
+    {
+        for (auto& c : completed) m_receiveHandler(c.first, c.second);
+    }
+}
+
+void BulkTransfer::update(float dt)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto budget = fragmentsPerUpdate;
+    for (auto& transfer : m_outgoing)
+    {
+        transfer.time += dt;
+        transfer.idleTime += dt;
+
+        //first time sends
+        while (transfer.nextFragment < transfer.acked.size() && budget > 0)
+        {
+            sendFragment(transfer, transfer.nextFragment++);
+            budget--;
+        }
+
+        //no news from the receiver, which might not have got anything at all
+        if (transfer.nextFragment == transfer.acked.size()
+            && transfer.time - transfer.lastStatus > silenceInterval)
+        {
+            for (auto i = 0u; i < transfer.acked.size() && budget > 0; ++i)
+            {
+                if (!transfer.acked[i] && transfer.time - transfer.sendTimes[i] > silenceInterval)
+                {
+                    sendFragment(transfer, i);
+                    budget--;
+                }
+            }
+        }
+    }
+
+    m_outgoing.erase(std::remove_if(m_outgoing.begin(), m_outgoing.end(),
+        [](const Outgoing& transfer)
+    {
+        if (transfer.idleTime > transferTimeout)
+        {
+            LOG("Bulk transfer " + std::to_string(transfer.id) + " timed out sending", xy::Logger::Type::Warning);
+            return true;
+        }
+        return false;
+    }), m_outgoing.end());
+
+    for (auto& transfer : m_incoming)
+    {
+        transfer.idleTime += dt;
+        transfer.statusTimer += dt;
+        if (transfer.statusTimer >= statusInterval)
+        {
+            transfer.statusTimer = 0.f;
+            sendStatus(transfer);
+        }
+    }
+
+    m_incoming.erase(std::remove_if(m_incoming.begin(), m_incoming.end(),
+        [](const Incoming& transfer)
+    {
+        if (transfer.idleTime > transferTimeout)
+        {
+            LOG("Bulk transfer " + std::to_string(transfer.id) + " timed out receiving", xy::Logger::Type::Warning);
+            return true;
+        }
+        return false;
+    }), m_incoming.end());
+}
+
+void BulkTransfer::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_outgoing.clear();
+    m_incoming.clear();
+    m_completed.fill(0);
+}
+
+//private
+void BulkTransfer::sendFragment(Outgoing& transfer, std::size_t index)
+{
+    XY_ASSERT(m_sendFunction, "Bulk transfer has no send function");
+
+    transfer.sendTimes[index] = transfer.time;
+
+    sf::Packet packet;
+    packet << PacketIdent::Fragment << m_clientID;
+    packet << transfer.id << sf::Uint8(transfer.channel);
+    packet << sf::Uint16(transfer.acked.size()) << sf::Uint32(transfer.data.size()) << sf::Uint16(index);
+
+    auto start = transfer.data.begin() + (index * FragmentSize);
+    std::vector<sf::Uint8> fragment(start, start + fragmentLength(index, transfer.data.size()));
+    Blob::write(packet, fragment);
+
+    m_sendFunction(packet);
+}
+
+void BulkTransfer::sendStatus(const Incoming& transfer)
+{
+    XY_ASSERT(m_sendFunction, "Bulk transfer has no send function");
+
+    BitWriter bits;
+    for (auto received : transfer.received) bits.writeBool(received);
+
+    sf::Packet packet;
+    packet << PacketIdent::FragmentStatus << m_clientID << transfer.id << false;
+    packet << bits;
+    m_sendFunction(packet);
+}
+
+void BulkTransfer::sendComplete(sf::Uint16 id)
+{
+    XY_ASSERT(m_sendFunction, "Bulk transfer has no send function");
+
+    sf::Packet packet;
+    packet << PacketIdent::FragmentStatus << m_clientID << id << true;
+    m_sendFunction(packet);
+}
+
+void BulkTransfer::handleFragment(sf::Packet& packet, std::vector<std::pair<BulkChannel, std::vector<sf::Uint8>>>& completed)
+{
+    sf::Uint16 id, count, index;
+    sf::Uint8 channel;
+    sf::Uint32 totalSize;
+    packet >> id >> channel >> count >> totalSize >> index;
+
+    std::vector<sf::Uint8> fragment;
+    if (!Blob::read(packet, fragment)) return;
+
+    if (count == 0 || count > MaxFragments || index >= count
+        || totalSize > count * FragmentSize || totalSize <= (count - 1) * FragmentSize
+        || fragment.size() != fragmentLength(index, totalSize))
+    {
+        return;
+    }
+
+    if (std::find(m_completed.begin(), m_completed.end(), id) != m_completed.end())
+    {
+        //our completion status must have been lost
+        sendComplete(id);
+        return;
+    }
+
+    auto result = std::find_if(m_incoming.begin(), m_incoming.end(),
+        [id](const Incoming& transfer) { return transfer.id == id; });
+
+    if (result == m_incoming.end())
+    {
+        //the sender will try again once we've made room
+        if (m_incoming.size() >= MaxTransfers) return;
+
+        Incoming transfer;
+        transfer.id = id;
+        transfer.channel = static_cast<BulkChannel>(channel);
+        transfer.data.resize(totalSize);
+        transfer.received.resize(count, false);
+        m_incoming.push_back(std::move(transfer));
+        result = m_incoming.end() - 1;
+    }
+    else if (result->received.size() != count || result->data.size() != totalSize)
+    {
+        return;
+    }
+
+    auto& transfer = *result;
+    if (!transfer.received[index])
+    {
+        std::copy(fragment.begin(), fragment.end(), transfer.data.begin() + (index * FragmentSize));
+        transfer.received[index] = true;
+        transfer.receivedCount++;
+        transfer.idleTime = 0.f;
+    }
+
+    if (transfer.receivedCount == transfer.received.size())
+    {
+        completed.emplace_back(transfer.channel, std::move(transfer.data));
+        m_completed[m_completedIndex] = id;
+        m_completedIndex = (m_completedIndex + 1) % m_completed.size();
+        sendComplete(id);
+        m_incoming.erase(result);
+    }
+}
+
+void BulkTransfer::handleStatus(sf::Packet& packet)
+{
+    sf::Uint16 id;
+    bool complete;
+    packet >> id >> complete;
+
+    auto result = std::find_if(m_outgoing.begin(), m_outgoing.end(),
+        [id](const Outgoing& transfer) { return transfer.id == id; });
+    if (result == m_outgoing.end()) return;
+
+    if (complete)
+    {
+        m_outgoing.erase(result);
+        return;
+    }
+
+    BitReader bits;
+    packet >> bits;
+
+    auto& transfer = *result;
+    transfer.lastStatus = transfer.time;
+
+    //anything missing below the highest fragment received is a gap, rather than still in flight
+    std::size_t highest = 0;
+    for (auto i = 0u; i < transfer.acked.size(); ++i)
+    {
+        if (bits.readBool())
+        {
+            if (!transfer.acked[i])
+            {
+                transfer.acked[i] = true;
+                transfer.idleTime = 0.f;
+            }
+            highest = i;
+        }
+    }
+    if (!bits.valid()) return;
+
+    for (auto i = 0u; i < highest; ++i)
+    {
+        if (!transfer.acked[i] && transfer.time - transfer.sendTimes[i] > resendInterval)
+        {
+            sendFragment(transfer, i);
+        }
+    }
+}
@@ -0,0 +1,312 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+#include <components/ClippingParticles.hpp>
+#include <components/PlayerDrawable.hpp>
+
+#include <xygine/Entity.hpp>
+#include <xygine/Assert.hpp>
+#include <xygine/util/Random.hpp>
+#include <xygine/util/Vector.hpp>
+
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/Texture.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    const float tileSize = 64.f;
+    //same as the PlayerLogic move speed, so that a mower moving at normal
+    //speed emits at the rate in the particle files
+    const float mowerSpeed = 200.f;
+    //anything further than this in a single frame is a snap or a
+    //respawn rather than the mower cutting grass
+    const float maxStep = tileSize * 2.f;
+
+    //these match the affectors in the mow_*.xyp files
+    const float dragStrength = 25.f;
+    const float growthRate = 1.2f;
+
+    //emission starts thinning out once the pool is this full, and the
+    //particles which are emitted are made larger to cover the gaps
+    const float lodStart = 0.5f;
+    const float maxSizeScale = 2.f;
+
+    //indexed by Direction
+    const std::array<std::string, static_cast<std::size_t>(Direction::Count)> definitionIDs =
+    {
+        "mow_left",
+        "mow_up",
+        "mow_right",
+        "mow_down"
+    };
+}
+
+ClippingParticles::ClippingParticles(xy::MessageBus& mb, AssetManager::Lease& assets)
+    : xy::Component (mb, this),
+    m_texture       (nullptr),
+    m_count         (0),
+    m_budget        (0)
+{
+    for (auto i = 0u; i < m_styles.size(); ++i)
+    {
+        const auto& definition = assets.getParticles(definitionIDs[i]);
+        auto& style = m_styles[i];
+
+        style.velocities = definition.randomInitialVelocities;
+        if (style.velocities.empty()) style.velocities.push_back(definition.initialVelocity);
+        style.positions = definition.randomInitialPositions;
+        if (style.positions.empty()) style.positions.push_back(definition.particlePosition);
+
+        //clippings slow down against the direction they're thrown
+        sf::Vector2f mean;
+        for (const auto& v : style.velocities) mean += v;
+        if (xy::Util::Vector::lengthSquared(mean) > 0.f)
+        {
+            style.drag = -xy::Util::Vector::normalise(mean) * dragStrength;
+        }
+
+        style.size = definition.particleSize;
+        style.colour = definition.colour;
+        style.lifetime = std::max(0.01f, definition.lifetime);
+        style.particlesPerTile = definition.emitRate * definition.releaseCount * (tileSize / mowerSpeed);
+
+        if (definition.texture) m_texture = definition.texture;
+    }
+    m_blendMode = assets.getParticles(definitionIDs[static_cast<std::size_t>(Direction::Right)]).blendMode;
+
+    setBudget(DefaultBudget);
+}
+
+//public
+void ClippingParticles::entityUpdate(xy::Entity&, float dt)
+{
+    integrate(dt);
+    removeDead();
+
+    auto fill = static_cast<float>(m_count) / m_budget;
+    auto lod = (fill < lodStart) ? 1.f : std::max(0.f, (1.f - fill) / (1.f - lodStart));
+    for (auto& mower : m_mowers)
+    {
+        emit(mower, lod);
+    }
+
+    updateVertices();
+}
+
+void ClippingParticles::addMower(xy::Entity& entity)
+{
+    auto result = std::find_if(m_mowers.begin(), m_mowers.end(),
+        [&entity](const Mower& m) { return m.entity == &entity; });
+    if (result != m_mowers.end()) return;
+
+    Mower mower;
+    mower.entity = &entity;
+    mower.drawable = entity.getComponent<PlayerDrawable>();
+    mower.lastPosition = entity.getPosition();
+    XY_ASSERT(mower.drawable, "Mower has no drawable");
+    m_mowers.push_back(mower);
+}
+
+void ClippingParticles::removeMower(const xy::Entity& entity)
+{
+    m_mowers.erase(std::remove_if(m_mowers.begin(), m_mowers.end(),
+        [&entity](const Mower& m) { return m.entity == &entity; }), m_mowers.end());
+}
+
+void ClippingParticles::setBudget(std::size_t budget)
+{
+    XY_ASSERT(budget > 0, "Particle budget must be greater than zero");
+    m_budget = budget;
+    m_count = std::min(m_count, m_budget);
+
+    //everything is allocated up front so emitting never allocates
+    m_positionX.resize(budget);
+    m_positionY.resize(budget);
+    m_velocityX.resize(budget);
+    m_velocityY.resize(budget);
+    m_dragX.resize(budget);
+    m_dragY.resize(budget);
+    m_life.resize(budget);
+    m_age.resize(budget);
+    m_invLifetime.resize(budget);
+    m_halfWidth.resize(budget);
+    m_halfHeight.resize(budget);
+    m_colours.resize(budget);
+    m_vertices.resize(budget * 4);
+
+    if (m_texture)
+    {
+        sf::Vector2f textureSize(m_texture->getSize());
+        for (auto i = 0u; i < m_vertices.size(); i += 4)
+        {
+            m_vertices[i + 1].texCoords.x = textureSize.x;
+            m_vertices[i + 2].texCoords = textureSize;
+            m_vertices[i + 3].texCoords.y = textureSize.y;
+        }
+    }
+}
+
+void ClippingParticles::clear()
+{
+    m_count = 0;
+    for (auto& mower : m_mowers)
+    {
+        mower.lastPosition = mower.entity->getPosition();
+        mower.pending = 0.f;
+    }
+}
+
+//private
+void ClippingParticles::emit(Mower& mower, float lod)
+{
+    auto position = mower.entity->getPosition();
+    auto distance = xy::Util::Vector::length(position - mower.lastPosition);
+    mower.lastPosition = position;
+    if (distance > maxStep) return;
+
+    const auto& style = m_styles[static_cast<std::size_t>(mower.drawable->getDirection())];
+    mower.pending += (distance / tileSize) * style.particlesPerTile * lod;
+
+    auto count = static_cast<int>(mower.pending);
+    mower.pending -= count;
+
+    auto sizeScale = (lod > 0.f) ? std::min(maxSizeScale, 1.f / std::sqrt(lod)) : maxSizeScale;
+    while (count-- > 0 && m_count < m_budget)
+    {
+        spawn(style, position, sizeScale);
+    }
+}
+
+void ClippingParticles::spawn(const Style& style, const sf::Vector2f& position, float sizeScale)
+{
+    auto i = m_count++;
+
+    const auto& offset = style.positions[xy::Util::Random::value(0, static_cast<int>(style.positions.size()) - 1)];
+    const auto& velocity = style.velocities[xy::Util::Random::value(0, static_cast<int>(style.velocities.size()) - 1)];
+
+    m_positionX[i] = position.x + offset.x;
+    m_positionY[i] = position.y + offset.y;
+    m_velocityX[i] = velocity.x;
+    m_velocityY[i] = velocity.y;
+    m_dragX[i] = style.drag.x;
+    m_dragY[i] = style.drag.y;
+    m_life[i] = style.lifetime;
+    m_age[i] = 0.f;
+    m_invLifetime[i] = 1.f / style.lifetime;
+    m_halfWidth[i] = style.size.x * 0.5f * sizeScale;
+    m_halfHeight[i] = style.size.y * 0.5f * sizeScale;
+    m_colours[i] = style.colour;
+}
+
+void ClippingParticles::integrate(float dt)
+{
+    //each array is walked in a separate simple loop without any
+    //branches so the compiler is able to vectorise them
+    const auto count = m_count;
+
+    auto* velocityX = m_velocityX.data();
+    const auto* dragX = m_dragX.data();
+    for (std::size_t i = 0; i < count; ++i) velocityX[i] += dragX[i] * dt;
+
+    auto* velocityY = m_velocityY.data();
+    const auto* dragY = m_dragY.data();
+    for (std::size_t i = 0; i < count; ++i) velocityY[i] += dragY[i] * dt;
+
+    auto* positionX = m_positionX.data();
+    for (std::size_t i = 0; i < count; ++i) positionX[i] += velocityX[i] * dt;
+
+    auto* positionY = m_positionY.data();
+    for (std::size_t i = 0; i < count; ++i) positionY[i] += velocityY[i] * dt;
+
+    auto* life = m_life.data();
+    for (std::size_t i = 0; i < count; ++i) life[i] -= dt;
+
+    auto* age = m_age.data();
+    for (std::size_t i = 0; i < count; ++i) age[i] += dt;
+}
+
+void ClippingParticles::removeDead()
+{
+    //dead particles are replaced by the last live one, which keeps
+    //the arrays packed. Draw order doesn't matter for clippings
+    for (auto i = 0u; i < m_count;)
+    {
+        if (m_life[i] > 0.f)
+        {
+            ++i;
+            continue;
+        }
+
+        auto last = --m_count;
+        m_positionX[i] = m_positionX[last];
+        m_positionY[i] = m_positionY[last];
+        m_velocityX[i] = m_velocityX[last];
+        m_velocityY[i] = m_velocityY[last];
+        m_dragX[i] = m_dragX[last];
+        m_dragY[i] = m_dragY[last];
+        m_life[i] = m_life[last];
+        m_age[i] = m_age[last];
+        m_invLifetime[i] = m_invLifetime[last];
+        m_halfWidth[i] = m_halfWidth[last];
+        m_halfHeight[i] = m_halfHeight[last];
+        m_colours[i] = m_colours[last];
+    }
+}
+
+void ClippingParticles::updateVertices()
+{
+    for (auto i = 0u; i < m_count; ++i)
+    {
+        auto scale = 1.f + growthRate * m_age[i];
+        auto halfWidth = m_halfWidth[i] * scale;
+        auto halfHeight = m_halfHeight[i] * scale;
+
+        auto colour = m_colours[i];
+        colour.a = static_cast<sf::Uint8>(colour.a * std::min(1.f, std::max(0.f, m_life[i] * m_invLifetime[i])));
+
+        auto* quad = &m_vertices[i * 4];
+        quad[0].position = { m_positionX[i] - halfWidth, m_positionY[i] - halfHeight };
+        quad[1].position = { m_positionX[i] + halfWidth, m_positionY[i] - halfHeight };
+        quad[2].position = { m_positionX[i] + halfWidth, m_positionY[i] + halfHeight };
+        quad[3].position = { m_positionX[i] - halfWidth, m_positionY[i] + halfHeight };
+        quad[0].color = quad[1].color = quad[2].color = quad[3].color = colour;
+    }
+}
+
+void ClippingParticles::draw(sf::RenderTarget& rt, sf::RenderStates states) const
+{
+    if (m_count == 0) return;
+
+    states.texture = m_texture;
+    states.blendMode = m_blendMode;
+    rt.draw(m_vertices.data(), m_count * 4, sf::Quads, states);
+}
@@ -28,6 +28,7 @@ source distribution.
 -----------------------------------------------------------------------*/
 
 #include <Game.hpp>
+#include <LaunchOptions.hpp>
 #include <StateIds.hpp>
 #include <GameState.hpp>
 #include <MenuBackgroundState.hpp>
@@ -36,14 +37,26 @@ source distribution.
 #include <MenuMainState.hpp>
 #include <MenuOptionState.hpp>
 #include <MenuPauseState.hpp>
+#include <LoopbackLink.hpp>
 
 #include <SFML/Window/Event.hpp>
 
 
-Game::Game()
-    : m_stateStack  ({ getRenderWindow(), *this })
+Game::Game(const LaunchOptions& options)
+    : m_assets      ("assets/manifest.json", "assets.pak"),
+    m_stateStack    ({ getRenderWindow(), *this }),
+    m_spectating    (options.spectate),
+    m_interpolationDelay(options.interpolationDelay)
 {
     registerStates();
+    m_server.setReplicationMode(options.replicationMode);
+    m_server.setProfilerOutput(options.profilerOutput, options.profilerInterval);
+    m_server.setRecordPath(options.recordPath);
+    if (options.link == LaunchOptions::Link::Loopback)
+    {
+        m_server.setLink(std::make_unique<LoopbackServerLink>());
+    }
+    m_server.setNetworkConditions(options.network);
 
 #ifndef _DEBUG_
     //normally intro
@@ -125,11 +138,11 @@ void Game::finalise()
 
 void Game::registerStates()
 {
-    m_stateStack.registerState<MenuBackgroundState>(States::ID::MenuBackground);
-    m_stateStack.registerState<MenuMainState>(States::ID::MenuMain);
-    m_stateStack.registerState<MenuLobbyState>(States::ID::MenuLobby);
-    m_stateStack.registerState<MenuJoinState>(States::ID::MenuJoin);
-    m_stateStack.registerState<MenuOptionState>(States::ID::MenuOptions);
-    m_stateStack.registerState<MenuPauseState>(States::ID::MenuPaused);
-    m_stateStack.registerState<GameState>(States::ID::Game);
+    m_stateStack.registerState<MenuBackgroundState>(States::ID::MenuBackground, m_assets);
+    m_stateStack.registerState<MenuMainState>(States::ID::MenuMain, m_assets);
+    m_stateStack.registerState<MenuLobbyState>(States::ID::MenuLobby, m_assets);
+    m_stateStack.registerState<MenuJoinState>(States::ID::MenuJoin, m_assets);
+    m_stateStack.registerState<MenuOptionState>(States::ID::MenuOptions, m_assets);
+    m_stateStack.registerState<MenuPauseState>(States::ID::MenuPaused, m_assets);
+    m_stateStack.registerState<GameState>(States::ID::Game, m_assets, m_server, m_spectating, m_interpolationDelay);
 }
@@ -31,78 +31,270 @@ source distribution.
 #include <NetProtocol.hpp>
 #include <Messages.hpp>
 #include <PacketEnums.hpp>
+#include <UdpLink.hpp>
+#include <ImpairedLink.hpp>
 
 #include <xygine/Entity.hpp>
+#include <xygine/Assert.hpp>
+#include <xygine/Reports.hpp>
 #include <components/PlayerLogic.hpp>
 
 namespace
 {
-    const float snapshotInterval = 1 / 20.f;
-    const sf::Uint8 MAX_PROGRAM_SIZE = 255;
+    //snapshot rates are adjusted per client between these
+    const float minSnapshotRate = 4.f;
+    const float maxSnapshotRate = 30.f;
+    //fraction of lost snapshots above which a client's rate is backed off
+    const float lossThreshold = 0.1f;
+    //in event mode clients only need the occasional hash to check they're in sync
+    const float checksumInterval = 0.5f;
+    //time per update shared between mowers playing at max speed
+    const sf::Time maxSpeedBudget = sf::milliseconds(8);
+    //spectators all get the same stream at a fixed rate
+    const float spectatorInterval = 1.f / 20.f;
+    const sf::Uint32 spectatorKeyframeInterval = 20;
 }
 
 using namespace std::placeholders;
 
 GameServer::GameServer()
-    : m_scene(m_messageBus),
-    m_connection(m_messageBus)
+    : m_scene           (m_messageBus),
+    m_serverTime        (0.f),
+    m_snapshotSequence  (0),
+    m_replicationMode   (ReplicationMode::Snapshots),
+    m_checksumAccumulator(0.f),
+    m_spectatorAccumulator(0.f),
+    m_spectatorSequence (0),
+    m_spectatorFrameCount(0)
 {
-    m_packetHandler = std::bind(&GameServer::handlePacket, this, _1, _2, _3, _4, _5);
-    m_connection.setPacketHandler(m_packetHandler);
+    setLink(std::make_unique<UdpServerLink>(m_messageBus));
     setup();
 }
 
 //public
+void GameServer::setLink(std::unique_ptr<ServerLink> link)
+{
+    XY_ASSERT(link, "Server link is null");
+    m_connection = std::move(link);
+    m_connection->setPacketHandler(std::bind(&GameServer::handlePacket, this, _1, _2, _3));
+    m_connection->setTimeoutHandler(std::bind(&GameServer::removePlayer, this, _1));
+}
+
+void GameServer::setNetworkConditions(const NetworkConditions& conditions)
+{
+    if (!conditions.enabled()) return;
+    setLink(std::make_unique<ImpairedServerLink>(std::move(m_connection), conditions));
+}
+
 bool GameServer::start()
 {
-    return m_connection.start();
+    if (!m_recordPath.empty())
+    {
+        //the lawn isn't generated yet, so there's no seed to record
+        m_recorder.open(m_recordPath, 0);
+    }
+    return m_connection->start();
 }
 
 void GameServer::stop()
 {
-    m_connection.stop();
+    m_connection->stop();
+    m_recorder.close();
+
+    for (auto& p : m_players)
+    {
+        p.entity->destroy();
+    }
+    m_players.clear();
+    m_clientStates.clear();
+    m_spectators.clear();
+    m_programStore.clear();
 }
 
 void GameServer::update(float dt)
 {
-    while (!m_messageBus.empty())
+    auto elapsed = m_snapshotClock.restart().asSeconds();
+    m_serverTime += elapsed;
+    m_profiler.update(elapsed);
+
+    TickProfiler::ScopedTimer tickTimer(m_profiler, TickProfiler::Tick);
+    {
+        TickProfiler::ScopedTimer timer(m_profiler, TickProfiler::Messages);
+        while (!m_messageBus.empty())
+        {
+            const auto& msg = m_messageBus.poll();
+            handleMessage(msg);
+            m_scene.handleMessage(msg);
+        }
+    }
+
     {
-        const auto& msg = m_messageBus.poll();
-        handleMessage(msg);
-        m_scene.handleMessage(msg);
+        TickProfiler::ScopedTimer timer(m_profiler, TickProfiler::Scene);
+        updateStepBudgets();
+        m_scene.update(dt);
     }
 
-    m_scene.update(dt);
-    m_connection.update(dt);
+    {
+        TickProfiler::ScopedTimer timer(m_profiler, TickProfiler::Connection);
+        m_connection->update(dt);
+        for (auto& cs : m_clientStates) cs.second.bulkTransfer.update(elapsed);
+    }
 
-    m_snapshotAccumulator += m_snapshotClock.restart().asSeconds();
-    while (m_snapshotAccumulator >= snapshotInterval)
+    TickProfiler::ScopedTimer timer(m_profiler, TickProfiler::Replication);
+    if (m_replicationMode == ReplicationMode::Snapshots)
     {
-        m_snapshotAccumulator -= snapshotInterval;
-        sendSnapshot();
+        //each client is sent snapshots at a rate its link can handle.
+        //the world state is only gathered if at least one is due
+        bool built = false;
+        bool sent = false;
+        for (auto& cs : m_clientStates)
+        {
+            auto& client = cs.second;
+            if (!client.player) continue;
+            updateSendRate(cs.first, client, elapsed);
+
+            client.sendAccumulator += elapsed;
+            auto interval = 1.f / client.sendRate;
+            if (client.sendAccumulator >= interval)
+            {
+                //don't let a stalled update cause a burst of snapshots
+                client.sendAccumulator = std::min(client.sendAccumulator - interval, interval);
+
+                if (!built)
+                {
+                    buildSnapshot(m_currentSnapshot, m_snapshotSequence);
+                    built = true;
+                }
+                sent = sendSnapshot(cs.first, client) || sent;
+            }
+        }
+        if (sent) m_snapshotSequence++;
     }
+
+    m_checksumAccumulator += elapsed;
+    if (m_checksumAccumulator >= checksumInterval)
+    {
+        m_checksumAccumulator = 0.f;
+        sendChecksums();
+    }
+
+    //reliable messages queued this tick go out together
+    for (auto& cs : m_clientStates)
+    {
+        flushMessages(cs.first, cs.second);
+    }
+
+    //players are always served first
+    updateSpectators(elapsed);
 }
 
 //private
+void GameServer::send(xy::ClientID id, sf::Packet& packet, bool retry)
+{
+    auto client = m_clientStates.find(id);
+    if (retry && client != m_clientStates.end())
+    {
+        auto message = m_packetPool.acquire();
+        message->append(packet.getData(), packet.getDataSize());
+        client->second.messages.push_back(std::move(message));
+        return;
+    }
+
+    m_profiler.addTraffic(id, packet.getDataSize());
+    m_connection->send(id, packet, retry);
+}
+
+void GameServer::broadcast(sf::Packet& packet, bool retry)
+{
+    if (retry)
+    {
+        //everyone shares the same copy until their batch is written
+        auto message = m_packetPool.acquire();
+        message->append(packet.getData(), packet.getDataSize());
+        for (auto& cs : m_clientStates)
+        {
+            cs.second.messages.push_back(message);
+        }
+        return;
+    }
+
+    for (const auto& cs : m_clientStates)
+    {
+        m_profiler.addTraffic(cs.first, packet.getDataSize());
+    }
+    m_connection->broadcast(packet, retry);
+}
+
+void GameServer::flushMessages(xy::ClientID id, ClientState& client)
+{
+    auto& messages = client.messages;
+    std::size_t first = 0;
+    while (first < messages.size())
+    {
+        //take as many messages as fit in one datagram
+        auto last = first + 1;
+        auto size = Batch::HeaderSize + Batch::EntrySize + messages[first]->getDataSize();
+        while (last < messages.size() && (last - first) < Batch::MaxCount
+            && size + Batch::EntrySize + messages[last]->getDataSize() <= Batch::MaxSize)
+        {
+            size += Batch::EntrySize + messages[last]->getDataSize();
+            last++;
+        }
+
+        if (last - first == 1)
+        {
+            m_profiler.addTraffic(id, messages[first]->getDataSize());
+            m_connection->send(id, *messages[first], true);
+        }
+        else
+        {
+            auto batch = m_packetPool.acquire();
+            *batch << PacketIdent::MessageBatch << static_cast<sf::Uint8>(last - first);
+            for (auto i = first; i < last; ++i)
+            {
+                *batch << static_cast<sf::Uint16>(messages[i]->getDataSize());
+            }
+            for (auto i = first; i < last; ++i)
+            {
+                batch->append(messages[i]->getData(), messages[i]->getDataSize());
+            }
+            m_profiler.addTraffic(id, batch->getDataSize());
+            m_connection->send(id, *batch, true);
+        }
+        first = last;
+    }
+    messages.clear();
+}
+
 void GameServer::handleMessage(const xy::Message& msg)
 {
     switch (msg.id)
     {
     case DirectionMessage:
     {
+        //clients simulating the program work out direction for themselves
+        if (m_replicationMode == ReplicationMode::Events) break;
+
+        //at max speed a mower may turn many times per update, so leave it to the snapshots
         auto& msgData = msg.getData<DirectionEvent>();
-        sf::Packet packet;
-        packet << DirectionUpdate;
-        packet << msgData.id << msgData.direction;
-        m_connection.broadcast(packet);
+        auto player = m_players.find(msgData.id);
+        if (player && player->entity->getComponent<PlayerLogic>()->getSpeed() == TransportSpeed::Max) break;
+
+        auto packet = m_packetPool.acquire();
+        *packet << DirectionUpdate;
+        *packet << msgData.id << msgData.direction;
+        broadcast(*packet);
     }
         break;
     case PlayerMessage:
     {
         const auto& msgData = msg.getData<PlayerEvent>();
-        sf::Packet packet;
-        packet << ProgramStatus << msgData.action;
-        m_connection.send(msgData.id, packet, true);
+        if (msgData.action == PlayerEvent::FinishedProgram)
+        {
+            auto packet = m_packetPool.acquire();
+            *packet << ProgramStatus << ProgramState::Finished;
+            send(msgData.id, *packet, true);
+        }
     }
         break;
     default: break;
@@ -115,113 +307,402 @@ void GameServer::setup()
 
 }
 
-void GameServer::addPlayer(Player& player)
+GameServer::ClientState& GameServer::addClient(xy::ClientID id)
 {
+    auto result = m_clientStates.emplace(std::piecewise_construct, std::forward_as_tuple(id), std::forward_as_tuple());
+    auto& clientState = result.first->second;
+    if (result.second)
+    {
+        clientState.bulkTransfer.setClientID(id);
+        clientState.bulkTransfer.setSendFunction([this, id](sf::Packet& packet) { send(id, packet); });
+        clientState.bulkTransfer.setReceiveHandler([this, id](BulkChannel channel, std::vector<sf::Uint8>& data) { handleBulkData(id, channel, data); });
+    }
+    return clientState;
+}
+
+void GameServer::addPlayer(const Player& player)
+{
+    //clients send their details reliably so we may see them more than once
+    if (m_players.find(player.id)) return;
+
     //create entity for scene - TODO load spawn position from map
-    auto pl = xy::Component::create<PlayerLogic>(m_messageBus, sf::Vector2f(224.f, 160.f));
+    const sf::Vector2f spawnPosition(224.f, 160.f);
+    auto pl = xy::Component::create<PlayerLogic>(m_messageBus, spawnPosition);
     pl->setClientID(player.id);
 
     auto entity = xy::Entity::create(m_messageBus);
     entity->addComponent(pl);
-    player.entity = m_scene.addEntity(entity, xy::Scene::Layer::BackFront);
 
-    m_players.push_back(player);
+    Player newPlayer = player;
+    newPlayer.entity = m_scene.addEntity(entity, xy::Scene::Layer::BackFront);
+    auto handle = m_players.add(newPlayer);
+    addClient(player.id).player = true;
+
     LOG("SERVER - Adding player " + player.name, xy::Logger::Type::Info);
+    m_recorder.playerJoined(player.id, player.name, spawnPosition);
+
+    auto settings = m_packetPool.acquire();
+    *settings << PacketIdent::ServerSettings << m_replicationMode;
+    send(player.id, *settings, true);
+
+    //everyone needs to know which slot the newcomer's snapshots use,
+    //including the newcomer, who also needs to know about everyone else
+    sendRoster(player.id);
+    auto joined = m_packetPool.acquire();
+    *joined << PacketIdent::PlayerJoined << player.id << handle.index << player.name;
+    broadcast(*joined, true);
+
+    //bring the new client up to date with everyone already simulating
+    if (m_replicationMode == ReplicationMode::Events)
+    {
+        for (const auto& p : m_players)
+        {
+            if (p.id == player.id) continue;
+
+            auto logic = p.entity->getComponent<PlayerLogic>();
+            const auto& program = logic->getProgram();
 
-    //TODO broadcast to all clients
+            auto packet = m_packetPool.acquire();
+            *packet << PacketIdent::ReplicateProgram << p.id;
+            Blob::write(*packet, program);
+            send(player.id, *packet, true);
+
+            packet->clear();
+            *packet << PacketIdent::PlayerState << p.id << m_serverTime << logic->getState();
+            send(player.id, *packet, true);
+        }
+    }
 }
 
 void GameServer::removePlayer(xy::ClientID id)
 {
+    m_spectators.erase(std::remove(m_spectators.begin(), m_spectators.end(), id), m_spectators.end());
+    m_clientStates.erase(id);
+    m_profiler.removeClient(id);
+
+    auto player = m_players.find(id);
+    if (!player) return;
+
+    LOG("SERVER - Removing player " + player->name, xy::Logger::Type::Info);
+
+    m_recorder.playerLeft(id);
+    player->entity->destroy();
+    m_players.remove(player->handle);
+
+    auto left = m_packetPool.acquire();
+    *left << PacketIdent::PlayerLeft << id;
+    broadcast(*left, true);
+}
+
+void GameServer::sendRoster(xy::ClientID id)
+{
+    for (const auto& p : m_players)
+    {
+        if (p.id == id) continue;
 
+        auto packet = m_packetPool.acquire();
+        *packet << PacketIdent::PlayerJoined << p.id << p.handle.index << p.name;
+        send(id, *packet, true);
+    }
 }
 
-void GameServer::sendSnapshot()
+void GameServer::buildSnapshot(Snapshot& snapshot, xy::Network::SeqID sequence)
 {
-    sf::Packet packet;
-    packet << PacketIdent::PositionUpdate;
-    packet << sf::Uint8(m_players.size());
+    snapshot.clear();
+    snapshot.sequence = sequence;
     for (const auto& p : m_players)
     {
-        auto position = p.entity->getPosition();
-        packet << p.id << position.x << position.y;
+        Snapshot::Entry entry;
+        entry.slot = p.handle.index;
+        entry.position = p.entity->getPosition();
+        entry.direction = p.entity->getComponent<PlayerLogic>()->getDirection();
+        snapshot.add(entry);
     }
-    m_connection.broadcast(packet);
+    SnapshotCodec::quantise(snapshot);
 }
 
-void GameServer::handlePacket(const sf::IpAddress& ip, xy::PortNumber port, xy::Network::PacketType type, sf::Packet& packet, xy::Network::ServerConnection* connection)
+bool GameServer::sendSnapshot(xy::ClientID id, ClientState& client)
 {
+    //each client gets a delta against the last snapshot it acknowledged
+    //or a keyframe if that baseline has dropped out of the history
+    const auto* baseline = client.acked ? client.sentSnapshots.get(client.ackedSequence) : nullptr;
+
+    //nothing changed since the client's last known state
+    if (baseline && *baseline == m_currentSnapshot) return false;
+
+    //the client checks its prediction of its own mower against this
+    sf::Uint32 tick = 0, hash = 0;
+    if (auto player = m_players.find(id))
+    {
+        auto logic = player->entity->getComponent<PlayerLogic>();
+        tick = logic->getTick();
+        hash = logic->getStateHash();
+    }
+
+    auto packet = m_packetPool.acquire();
+    *packet << PacketIdent::PositionUpdate << m_serverTime << tick << hash;
+    SnapshotCodec::write(*packet, m_currentSnapshot, baseline);
+    send(id, *packet);
+
+    client.sentSnapshots.insert(m_currentSnapshot);
+    client.sendTimes[m_currentSnapshot.sequence % client.sendTimes.size()] = m_serverTime;
+    client.snapshotsSent++;
+    return true;
+}
+
+void GameServer::updateSpectators(float dt)
+{
+    if (m_spectators.empty()) return;
+
+    m_spectatorAccumulator += dt;
+    if (m_spectatorAccumulator < spectatorInterval) return;
+    m_spectatorAccumulator = std::min(m_spectatorAccumulator - spectatorInterval, spectatorInterval);
+
+    //spectators don't ack, so deltas are against the previous frame with regular
+    //keyframes. Anyone who misses a frame picks up again at the next keyframe
+    const bool keyframe = (m_spectatorFrameCount++ % spectatorKeyframeInterval) == 0;
+    auto& current = m_spectatorSnapshots[m_spectatorFrameCount % 2];
+    const auto& previous = m_spectatorSnapshots[(m_spectatorFrameCount + 1) % 2];
+    buildSnapshot(current, m_spectatorSequence++);
+
+    //encoded once and shared by everyone watching
+    auto frame = m_packetPool.acquire();
+    *frame << PacketIdent::SpectatorSnapshot << m_serverTime;
+    SnapshotCodec::write(*frame, current, keyframe ? nullptr : &previous);
+
+    for (auto id : m_spectators)
+    {
+        m_profiler.addTraffic(id, frame->getDataSize());
+        m_connection->send(id, *frame, false);
+    }
+}
+
+void GameServer::updateSendRate(xy::ClientID id, ClientState& client, float dt)
+{
+    //flow control raises the rate on fast links and drops it when the RTT climbs
+    client.flowControl.update(dt, client.roundTripTime);
+
+    //...and sustained loss backs the rate off further until it clears
+    client.statsAccumulator += dt;
+    if (client.statsAccumulator >= 1.f)
+    {
+        client.lossRate = (client.snapshotsSent > 0) ?
+            1.f - (static_cast<float>(std::min(client.snapshotsAcked, client.snapshotsSent)) / static_cast<float>(client.snapshotsSent)) : 0.f;
+
+        if (client.lossRate > lossThreshold)
+        {
+            client.lossScale = std::max(0.25f, client.lossScale * 0.5f);
+        }
+        else
+        {
+            client.lossScale = std::min(1.f, client.lossScale + 0.1f);
+        }
+
+        client.statsAccumulator = 0.f;
+        client.snapshotsSent = 0;
+        client.snapshotsAcked = 0;
+    }
+
+    client.sendRate = std::max(minSnapshotRate, std::min(maxSnapshotRate, client.flowControl.getSendRate() * client.lossScale));
+
+    REPORT("Client " + std::to_string(id) + " snapshots",
+        std::to_string(static_cast<int>(client.sendRate)) + "Hz, RTT: " + std::to_string(static_cast<int>(client.roundTripTime * 1000.f))
+        + "ms, loss: " + std::to_string(static_cast<int>(client.lossRate * 100.f)) + "%");
+}
+
+void GameServer::sendChecksums()
+{
+    for (const auto& p : m_players)
+    {
+        auto logic = p.entity->getComponent<PlayerLogic>();
+        if (logic->getTransportStatus() != TransportStatus::Playing) continue;
+
+        m_recorder.stateHash(p.id, logic->getTick(), logic->getStateHash());
+        if (m_replicationMode != ReplicationMode::Events) continue;
+
+        auto packet = m_packetPool.acquire();
+        *packet << PacketIdent::StateChecksum << p.id << logic->getTick() << logic->getStateHash();
+        broadcast(*packet);
+    }
+}
+
+void GameServer::replicateTransport(const Player& player, TransportChange change)
+{
+    m_recorder.transport(player.id, player.entity->getComponent<PlayerLogic>()->getTick(), change);
+    if (m_replicationMode != ReplicationMode::Events) return;
+
+    auto packet = m_packetPool.acquire();
+    *packet << PacketIdent::ReplicateTransport << player.id << change;
+    *packet << player.entity->getComponent<PlayerLogic>()->getTick();
+    broadcast(*packet, true);
+}
+
+void GameServer::updateStepBudgets()
+{
+    std::size_t count = 0;
+    for (const auto& p : m_players)
+    {
+        if (p.entity->getComponent<PlayerLogic>()->getSpeed() == TransportSpeed::Max) count++;
+    }
+    if (count == 0) return;
+
+    auto budget = sf::microseconds(maxSpeedBudget.asMicroseconds() / static_cast<sf::Int64>(count));
+    for (auto& p : m_players)
+    {
+        p.entity->getComponent<PlayerLogic>()->setStepBudget(budget);
+    }
+}
+
+void GameServer::setProgram(xy::ClientID clid, const ProgramStore::Program& program)
+{
+    //find player, set program if they exist
+    auto player = m_players.find(clid);
+    if (!player) return;
+
+    auto logic = player->entity->getComponent<PlayerLogic>();
+    logic->setProgram(program);
+    logic->start();
+    LOG("SERVER: set program for player " + std::to_string(clid), xy::Logger::Type::Info);
+    m_recorder.program(clid, logic->getTick(), program);
+
+    if (m_replicationMode == ReplicationMode::Events)
+    {
+        auto programPacket = m_packetPool.acquire();
+        *programPacket << PacketIdent::ReplicateProgram << clid;
+        Blob::write(*programPacket, program);
+        broadcast(*programPacket, true);
+    }
+    replicateTransport(*player, TransportChange::Play);
+
+    auto response = m_packetPool.acquire();
+    *response << TransportStateChanged << TransportStatus::Playing;
+    send(clid, *response, true);
+}
+
+void GameServer::handleBulkData(xy::ClientID clid, BulkChannel channel, std::vector<sf::Uint8>& data)
+{
+    switch (channel)
+    {
+    default: break;
+    case BulkChannel::Program:
+    {
+        auto client = m_clientStates.find(clid);
+        if (client == m_clientStates.end()) break;
+
+        auto& state = client->second;
+        auto digest = ProgramStore::digest(data);
+        auto response = m_packetPool.acquire();
+        if (state.expectedSize == 0)
+        {
+            LOG("SERVER: player " + std::to_string(clid) + " uploaded a program without announcing it", xy::Logger::Type::Warning);
+            *response << ProgramStatus << ProgramState::Rejected;
+            send(clid, *response, true);
+        }
+        else if (data.size() != state.expectedSize || digest != state.expectedDigest)
+        {
+            //damaged or out of date, so have the client start again
+            LOG("SERVER: program from player " + std::to_string(clid) + " doesn't match its digest", xy::Logger::Type::Warning);
+            *response << ProgramStatus << ProgramState::Resend;
+            send(clid, *response, true);
+        }
+        else if (!m_programStore.insert(digest, data))
+        {
+            LOG("SERVER: program from player " + std::to_string(clid) + " collides with a stored program", xy::Logger::Type::Warning);
+            *response << ProgramStatus << ProgramState::Rejected;
+            send(clid, *response, true);
+        }
+        else
+        {
+            setProgram(clid, data);
+        }
+        state.expectedSize = 0;
+    }
+        break;
+    }
+}
+
+void GameServer::handlePacket(xy::ClientID id, xy::Network::PacketType type, sf::Packet& packet)
+{
+    //client IDs written in packets are left over from before links reported
+    //the sender, and can't be trusted. They're read to skip them, but only
+    //the link's ID is used, so clients can only act as themselves
+    if (id == xy::Network::NullID) return;
+
+    xy::ClientID unusedID;
     switch (type)
     {
     default: break;
+        //reliable broadcasts are queued for the client from now on
+    case xy::Network::Connect:
+        addClient(id);
+        break;
         //create player on join
     case PacketIdent::PlayerDetails:
     {
         Player player;
-        packet >> player.id;
+        packet >> unusedID;
         packet >> player.name;
+        player.id = id;
         addPlayer(player);
 
         //TODO reply with map properties
     }
         break;
 
-        //receive program
+        //client wants to run a program, which we may already have
     case PacketIdent::TransmitProgram:
-        //TODO assert byte stream is correct size
-        //and send request for program again if not
     {
-        xy::ClientID clid;
+        ProgramStore::Digest digest;
         sf::Uint32 size;
-        packet >> clid >> size;
-        if (size > 0 && size < MAX_PROGRAM_SIZE)
+        packet >> unusedID >> digest >> size;
+        //always reply, as the client has already started its mower
+        auto response = m_packetPool.acquire();
+        if (size == 0 || size > MaxProgramSize)
         {
-            sf::Uint8 byte;
-            std::vector<sf::Uint8> program;
-            while (packet >> byte)
-            {
-                program.push_back(byte);
-            }
-
-            if (program.size() != size)
+            LOG("SERVER: program from player " + std::to_string(id) + " has an invalid size", xy::Logger::Type::Warning);
+            *response << ProgramStatus << ProgramState::Rejected;
+            send(id, *response, true);
+        }
+        else
+        {
+            const auto* program = m_programStore.find(digest);
+            if (program && program->size() == size)
             {
-                //failed transmission, send request for program again
-                sf::Packet response;
-                response << ProgramStatus << ProgramState::Resend;
-                m_connection.send(clid, response, true);
+                *response << ProgramStatus << ProgramState::Stored;
+                send(id, *response, true);
+                setProgram(id, *program);
             }
             else
             {
-                //find player, set program if they exist
-                auto player = std::find_if(m_players.begin(), m_players.end(),
-                    [clid](const Player& p) 
-                {
-                    return p.id == clid;
-                });
-                if (player != m_players.end())
+                auto client = m_clientStates.find(id);
+                if (client != m_clientStates.end() && client->second.player)
                 {
-                    player->entity->getComponent<PlayerLogic>()->setProgram(program);
-                    player->entity->getComponent<PlayerLogic>()->start();
-                    LOG("SERVER: set program for player " + std::to_string(clid), xy::Logger::Type::Info);
-
-                    sf::Packet response;
-                    response << TransportStateChanged << TransportStatus::Playing;
-                    m_connection.send(clid, response, true);
+                    client->second.expectedDigest = digest;
+                    client->second.expectedSize = size;
                 }
+                *response << ProgramStatus << ProgramState::Upload;
+                send(id, *response, true);
             }
         }
     }
         break;
-    case PacketIdent::TransportRequestChange:
+        //receive program and any other bulk data
+    case PacketIdent::Fragment:
+    case PacketIdent::FragmentStatus:
     {
-        xy::ClientID clid;
-        packet >> clid;
-        auto player = std::find_if(m_players.begin(), m_players.end(),
-            [clid](const Player& p)
+        packet >> unusedID;
+        auto client = m_clientStates.find(id);
+        if (client != m_clientStates.end())
         {
-            return p.id == clid;
-        });
-        if (player != m_players.end())
+            client->second.bulkTransfer.handlePacket(type, packet);
+        }
+    }
+        break;
+    case PacketIdent::TransportRequestChange:
+    {
+        packet >> unusedID;
+        auto player = m_players.find(id);
+        if (player)
         {
             TransportChange tc;
             packet >> tc;
@@ -244,20 +725,96 @@ void GameServer::handlePacket(const sf::IpAddress& ip, xy::PortNumber port, xy::
                 player->entity->getComponent<PlayerLogic>()->rewind();
 
                 {
-                    sf::Packet programPacket;
-                    programPacket << ProgramStatus << ProgramState::Rewound;
-                    m_connection.send(clid, programPacket, true);
+                    auto programPacket = m_packetPool.acquire();
+                    *programPacket << ProgramStatus << ProgramState::Rewound;
+                    send(id, *programPacket, true);
                 }
 
                 break;
             }
 
-            sf::Packet response;
-            response << TransportStateChanged << ts;
-            m_connection.send(clid, response, true);
+            replicateTransport(*player, tc);
+
+            auto response = m_packetPool.acquire();
+            *response << TransportStateChanged << ts;
+            send(id, *response, true);
+        }
+    }
+        break;
+    case PacketIdent::TransportRequestSpeed:
+    {
+        TransportSpeed speed;
+        packet >> unusedID >> speed;
+        auto player = m_players.find(id);
+        if (player)
+        {
+            auto logic = player->entity->getComponent<PlayerLogic>();
+            logic->setSpeed(speed);
+
+            //everyone needs this to interpolate, not just clients simulating programs
+            auto response = m_packetPool.acquire();
+            *response << PacketIdent::TransportSpeedChanged << id << speed << logic->getTick();
+            broadcast(*response, true);
+        }
+    }
+        break;
+    case PacketIdent::ResyncRequest:
+    {
+        xy::ClientID target;
+        packet >> unusedID >> target;
+        auto player = m_players.find(target);
+        if (player)
+        {
+            auto response = m_packetPool.acquire();
+            *response << PacketIdent::PlayerState << target << m_serverTime;
+            *response << player->entity->getComponent<PlayerLogic>()->getState();
+            send(id, *response, true);
+        }
+    }
+        break;
+    case PacketIdent::SnapshotAck:
+    {
+        xy::Network::SeqID sequence;
+        packet >> unusedID >> sequence;
+
+        auto client = m_clientStates.find(id);
+        if (client != m_clientStates.end())
+        {
+            //acks are unreliable and may arrive out of order
+            auto& state = client->second;
+            if (!state.acked || sequenceMoreRecent(sequence, state.ackedSequence))
+            {
+                state.ackedSequence = sequence;
+                state.acked = true;
+
+                if (state.sentSnapshots.get(sequence))
+                {
+                    auto rtt = m_serverTime - state.sendTimes[sequence % state.sendTimes.size()];
+                    state.roundTripTime = (state.roundTripTime == 0.f) ? rtt : state.roundTripTime + ((rtt - state.roundTripTime) * 0.1f);
+                }
+            }
+            state.snapshotsAcked++;
         }
     }
         break;
         //delete player on disconnect
+    case PacketIdent::SpectatorDetails:
+    {
+        std::string name;
+        packet >> unusedID >> name;
+        if (std::find(m_spectators.begin(), m_spectators.end(), id) == m_spectators.end())
+        {
+            LOG("SERVER: " + name + " is spectating", xy::Logger::Type::Info);
+            m_spectators.push_back(id);
+            addClient(id);
+            sendRoster(id);
+            //newcomers need a keyframe to start from
+            m_spectatorFrameCount = 0;
+        }
+    }
+        break;
+    case xy::Network::Disconnect:
+        removePlayer(id);
+        break;
     }
 }
\ No newline at end of file
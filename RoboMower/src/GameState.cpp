@@ -28,23 +28,26 @@ source distribution.
 -----------------------------------------------------------------------*/
 
 #include <GameState.hpp>
+#include <GameServer.hpp>
 #include <NetProtocol.hpp>
 #include <Messages.hpp>
 #include <components/Tilemap.hpp>
 #include <components/PlayerDrawable.hpp>
+#include <components/ClippingParticles.hpp>
 #include <components/NetworkController.hpp>
 #include <components/WhiteNoise.hpp>
+#include <components/PlayerLogic.hpp>
 
 #include <xygine/Reports.hpp>
 #include <xygine/Entity.hpp>
 #include <xygine/Command.hpp>
 #include <xygine/PostChromeAb.hpp>
 #include <xygine/ui/Label.hpp>
+#include <xygine/util/Vector.hpp>
 
 #include <xygine/App.hpp>
 #include <xygine/Log.hpp>
 
-#include <xygine/components/ParticleSystem.hpp>
 #include <CommandCategories.hpp>
 
 #include <SFML/Graphics/RenderWindow.hpp>
@@ -52,6 +55,9 @@ source distribution.
 #include <SFML/Network/Packet.hpp>
 #include <SFML/Network/Socket.hpp>
 
+#include <algorithm>
+#include <cmath>
+
 namespace
 {
     const sf::Keyboard::Key upKey = sf::Keyboard::W;
@@ -59,6 +65,22 @@ namespace
     const sf::Keyboard::Key leftKey = sf::Keyboard::A;
     const sf::Keyboard::Key rightKey = sf::Keyboard::D;
     const sf::Keyboard::Key fireKey = sf::Keyboard::Space;
+    //cycles through playback speeds
+    const sf::Keyboard::Key speedKey = sf::Keyboard::F;
+
+    const std::size_t maxSpectatorFrames = 64;
+
+    //remote mowers built up front. More are made if needed
+    const std::size_t playerPoolSize = 16;
+    //TODO load spawn position from map
+    const sf::Vector2f spawnPosition(224.f, 160.f);
+
+    //corrections to the local mower are drawn as an offset which fades
+    //at this rate, unless they're big enough to be a teleport
+    const float predictionErrorDecay = 10.f;
+    const float maxSmoothedError = 64.f;
+    //resync requests with no reply after this long are assumed lost
+    const float resyncTimeout = 2.f;
 
     const float joyDeadZone = 25.f;
     const float joyMaxAxis = 100.f;
@@ -66,25 +88,37 @@ namespace
 
 using namespace std::placeholders;
 
-GameState::GameState(xy::StateStack& stateStack, Context context)
+GameState::GameState(xy::StateStack& stateStack, Context context, AssetManager& assets,
+    GameServer& server, const bool& spectating, const float& interpolationDelay)
     : State             (stateStack, context),
     m_messageBus        (context.appInstance.getMessageBus()),
+    m_assets            (assets, "game"),
     m_scene             (m_messageBus),
-    m_gameUI            (context, m_textureResource, m_fontResource, m_scene),
-    m_programFinished   (true)
+    m_gameUI            (context, m_assets, m_scene),
+    m_connection        (server.createLocalClient()),
+    m_programFinished   (true),
+    m_localPlayer       (nullptr),
+    m_mapEntity         (nullptr),
+    m_clippings         (nullptr),
+    m_replicationMode   (ReplicationMode::Snapshots),
+    m_hasSnapshot       (false),
+    m_resyncTime        (0.f),
+    m_spectating        (spectating)
 {
     launchLoadingScreen();
+    m_interpolationClock.setDelay(interpolationDelay);
 
     //TODO handle failure to connect
-    m_packetHandler = std::bind(&GameState::handlePacket, this, _1, _2, _3);
-    m_connection.setPacketHandler(m_packetHandler);
-    m_connection.setServerInfo({ "127.0.0.1" }, xy::Network::ServerPort);
-    m_connection.connect();
+    m_connection->setPacketHandler(std::bind(&GameState::handlePacket, this, _1, _2));
+    m_bulkTransfer.setSendFunction([this](sf::Packet& packet) { m_connection->send(packet); });
+    m_connection->connect();
 
     m_scene.setView(context.defaultView);
     auto pp = xy::PostProcess::create<xy::PostChromeAb>();
     m_scene.addPostProcess(pp);
 
+    //the game's assets have been decoding in the background since
+    //m_assets was created, so this mostly just uploads the textures
     buildMap();
 
     context.appInstance.setMouseCursorVisible(false);
@@ -97,8 +131,42 @@ bool GameState::update(float dt)
     auto mousePos = rw.mapPixelToCoords(sf::Mouse::getPosition(rw));
     
     m_gameUI.update(dt, mousePos);
+    m_connection->update(dt);
+    m_interpolationClock.update(m_connection->getTime().asSeconds(), dt);
+    if (m_spectating) updateSpectating();
     m_scene.update(dt);
-    m_connection.update(dt);
+    m_bulkTransfer.update(dt);
+
+    //checkpoints which arrived early are only verified once we reach them.
+    //Remote mowers are only simulated when the server replicates events
+    for (const auto& slot : m_playerSlots)
+    {
+        if (!slot.entity
+            || (m_replicationMode != ReplicationMode::Events && slot.entity != m_localPlayer)) continue;
+
+        auto logic = slot.entity->getComponent<PlayerLogic>();
+        if (logic->desynchronised()) requestResync(slot.id);
+    }
+
+    //forget requests which went unanswered, so the mower can ask again
+    auto now = m_connection->getTime().asSeconds();
+    for (auto request = m_resyncRequests.begin(); request != m_resyncRequests.end();)
+    {
+        if (now - request->second > resyncTimeout)
+        {
+            request = m_resyncRequests.erase(request);
+        }
+        else
+        {
+            ++request;
+        }
+    }
+
+    if (m_localPlayer)
+    {
+        m_predictionError *= std::exp(-dt * predictionErrorDecay);
+        m_localPlayer->getComponent<PlayerDrawable>()->setPosition(m_predictionError);
+    }
 
     return true;
 }
@@ -142,6 +210,9 @@ bool GameState::handleEvent(const sf::Event& evt)
         case sf::Keyboard::P:
             requestStackPush(States::ID::MenuPaused);
             break;
+        case speedKey:
+            if (!m_spectating) requestNextSpeed();
+            break;
         case upKey:
 
             break;
@@ -193,8 +264,22 @@ void GameState::handleMessage(const xy::Message& msg)
     m_scene.handleMessage(msg);
     switch (msg.id)
     {
+    case MessageId::DirectionMessage:
+    {
+        //raised by our own copy of the simulation, which always
+        //runs for the local mower so that it can be predicted
+        const auto& msgData = msg.getData<DirectionEvent>();
+        auto entity = getPlayerEntity(msgData.id);
+        if (entity && (m_replicationMode == ReplicationMode::Events || entity == m_localPlayer))
+        {
+            setPlayerDirection(*entity, msgData.direction);
+        }
+    }
+        break;
     case MessageId::TransportMessage:
     {
+        if (m_spectating) break;
+
         const auto& msgData = msg.getData<TransportEvent>();
         switch (msgData.button)
         {
@@ -202,8 +287,9 @@ void GameState::handleMessage(const xy::Message& msg)
             if (m_gameUI.getTransportStatus() == TransportStatus::Playing)
             {
                 sf::Packet packet;
-                packet << PacketIdent::TransportRequestChange << m_connection.getClientID() << TransportChange::Pause;
-                m_connection.send(packet, true);
+                packet << PacketIdent::TransportRequestChange << m_connection->getClientID() << TransportChange::Pause;
+                m_connection->send(packet, true);
+                predictTransport(TransportChange::Pause);
             }
             break;
         case TransportEvent::Play:
@@ -211,21 +297,28 @@ void GameState::handleMessage(const xy::Message& msg)
             {
                 //get the program and send if valid
                 sendProgram();
+                if (!m_pendingProgram.empty())
+                {
+                    m_localPlayer->getComponent<PlayerLogic>()->setProgram(m_pendingProgram);
+                    predictTransport(TransportChange::Play);
+                }
             }
             else if(m_gameUI.getTransportStatus() == TransportStatus::Paused)
             {
                 //send a play request
                 sf::Packet packet;
-                packet << PacketIdent::TransportRequestChange << m_connection.getClientID() << TransportChange::Play;
-                m_connection.send(packet, true);
+                packet << PacketIdent::TransportRequestChange << m_connection->getClientID() << TransportChange::Play;
+                m_connection->send(packet, true);
+                predictTransport(TransportChange::Play);
             }
                 break;
         case TransportEvent::Rewind:
             if (m_gameUI.getTransportStatus() != TransportStatus::Playing)
             {
                 sf::Packet packet;
-                packet << PacketIdent::TransportRequestChange << m_connection.getClientID() << TransportChange::Rewind;
-                m_connection.send(packet, true);
+                packet << PacketIdent::TransportRequestChange << m_connection->getClientID() << TransportChange::Rewind;
+                m_connection->send(packet, true);
+                predictTransport(TransportChange::Rewind);
             }
             break;
         }
@@ -245,97 +338,267 @@ void GameState::buildMap()
     ent->addComponent(whiteNoise);
     m_scene.addEntity(ent, xy::Scene::Layer::BackRear);
 
-    auto tilemap = xy::Component::create<Tilemap>(m_messageBus, m_textureResource.get("assets/images/tileset.png"));
+    auto tilemap = xy::Component::create<Tilemap>(m_messageBus, m_assets.getTexture("tileset"), m_assets.getTileSet("tileset"));
     ent = xy::Entity::create(m_messageBus);
     ent->addComponent(tilemap);
     ent->setPosition(mapPos);
 
-    //player - TODO move to 'create player' function
-    auto playerDrawable = xy::Component::create<PlayerDrawable>(m_messageBus, m_textureResource.get("assets/images/tileset.png"), true);
+    m_mapEntity = m_scene.addEntity(ent, xy::Scene::Layer::BackRear);
+
+    //clippings from every mower are drawn in one go, over the top of the mowers
+    auto clippings = xy::Component::create<ClippingParticles>(m_messageBus, m_assets);
+    ent = xy::Entity::create(m_messageBus);
+    m_clippings = ent->addComponent(clippings);
+    ent->setPosition(mapPos);
+    m_scene.addEntity(ent, xy::Scene::Layer::BackMiddle);
+
+    //remote mowers are built now while the loading screen is up,
+    //and wait out of the scene until someone joins
+    m_playerPool.reserve(playerPoolSize);
+    for (auto i = 0u; i < playerPoolSize; ++i)
+    {
+        m_playerPool.push_back(createPlayerEntity(false));
+    }
+
+    //spectators only watch other people's mowers
+    if (!m_spectating)
+    {
+        auto playerEnt = createPlayerEntity(true);
+        m_localPlayer = m_mapEntity->addChild(playerEnt);
+        m_clippings->addMower(*m_localPlayer);
+    }
+}
+
+xy::Entity::Ptr GameState::createPlayerEntity(bool local)
+{
+    auto playerDrawable = xy::Component::create<PlayerDrawable>(m_messageBus, m_assets.getTexture("tileset"), m_assets.getTileSet("tileset"), local);
     auto playerEnt = xy::Entity::create(m_messageBus);
     playerEnt->addComponent(playerDrawable);
-    playerEnt->setPosition(224.f, 160.f);
-
-    xy::ParticleSystem::Definition pd;
-    pd.loadFromFile("assets/particles/mow_up.xyp", m_textureResource);
-    auto ps = pd.createSystem(m_messageBus);
-    playerEnt->addComponent(ps)->setName("particle_up");
-    pd.loadFromFile("assets/particles/mow_down.xyp", m_textureResource);
-    ps = pd.createSystem(m_messageBus);
-    playerEnt->addComponent(ps)->setName("particle_down");
-    pd.loadFromFile("assets/particles/mow_left.xyp", m_textureResource);
-    ps = pd.createSystem(m_messageBus);
-    playerEnt->addComponent(ps)->setName("particle_left");
-    pd.loadFromFile("assets/particles/mow_right.xyp", m_textureResource);
-    ps = pd.createSystem(m_messageBus);
-    playerEnt->addComponent(ps)->setName("particle_right");
-
-    auto netController = xy::Component::create<NetworkController>(m_messageBus);
+    playerEnt->setPosition(spawnPosition);
+
+    auto netController = xy::Component::create<NetworkController>(m_messageBus, m_interpolationClock);
     playerEnt->addComponent(netController);
 
+    //only used when the server replicates events rather than positions
+    auto playerLogic = xy::Component::create<PlayerLogic>(m_messageBus, spawnPosition);
+    playerEnt->addComponent(playerLogic);
+
     //TODO add text for player name
 
-    m_playerEntities[m_connection.getClientID()] = ent->addChild(playerEnt);
-    
-    m_scene.addEntity(ent, xy::Scene::Layer::BackRear);
+    return std::move(playerEnt);
 }
 
-void GameState::handlePacket(xy::Network::PacketType type, sf::Packet& packet, xy::Network::ClientConnection* connection)
+void GameState::handlePacket(xy::Network::PacketType type, sf::Packet& packet)
 {
     switch (type)
     {
     case xy::Network::Connect:
     {
+        //we may not have had an ID when the map was built. Our slot
+        //arrives with everyone else's once the server adds us
+        if (m_localPlayer)
+        {
+            m_localPlayer->getComponent<PlayerLogic>()->setClientID(m_connection->getClientID());
+        }
+
         sf::Packet newPacket;
-        newPacket << PacketIdent::PlayerDetails;
-        newPacket << m_connection.getClientID();
+        newPacket << (m_spectating ? PacketIdent::SpectatorDetails : PacketIdent::PlayerDetails);
+        newPacket << m_connection->getClientID();
         newPacket << "Player One";
-        connection->send(newPacket, true);
+        m_connection->send(newPacket, true);
     }
         break;
     case PacketIdent::PositionUpdate:
-        sf::Uint8 count;
-        packet >> count;
-        for (auto i = 0u; i < count; ++i)
+    {
+        float serverTime = 0.f;
+        sf::Uint32 tick = 0, hash = 0;
+        packet >> serverTime >> tick >> hash;
+        Snapshot snapshot;
+        if (!SnapshotCodec::read(packet, m_snapshots, snapshot)) break;
+        m_snapshots.insert(snapshot);
+
+        //ack every snapshot so the server can pick the newest baseline
+        sf::Packet ack;
+        ack << PacketIdent::SnapshotAck << m_connection->getClientID() << snapshot.sequence;
+        m_connection->send(ack);
+
+        //stale snapshots are still useful as baselines but shouldn't move anything
+        if (m_hasSnapshot && !sequenceMoreRecent(snapshot.sequence, m_latestSnapshot.sequence)) break;
+        m_latestSnapshot = snapshot;
+        m_hasSnapshot = true;
+        m_interpolationClock.addSample(serverTime, m_connection->getTime().asSeconds());
+        if (m_localPlayer) reconcile(serverTime, tick, hash);
+
+        for (const auto& entry : snapshot.entries)
         {
-            xy::ClientID id;
-            packet >> id;
-            sf::Vector2f position;
-            packet >> position.x >> position.y;
+            //we simulate our own mower, and newcomers may not have been announced yet
+            auto entity = getSlotEntity(entry.slot);
+            if (!entity || entity == m_localPlayer) continue;
+
+            entity->getComponent<NetworkController>()->addSample(serverTime, entry.position);
 
-            XY_ASSERT(m_playerEntities.find(id) != m_playerEntities.end(), "Player ID does not exist");
-            m_playerEntities[id]->getComponent<NetworkController>()->setDestination(position);
+            //direction updates are unreliable, so snapshots also correct any we missed
+            if (entity->getComponent<PlayerDrawable>()->getDirection() != entry.direction)
+            {
+                setPlayerDirection(*entity, entry.direction);
+            }
         }
+    }
         break;
-    case PacketIdent::DirectionUpdate:
+    case PacketIdent::SpectatorSnapshot:
+    {
+        SpectatorFrame frame;
+        packet >> frame.serverTime;
+        //frames missing their baseline are skipped until the next keyframe
+        if (!SnapshotCodec::read(packet, m_snapshots, frame.snapshot)) break;
+        m_snapshots.insert(frame.snapshot);
+        m_interpolationClock.addSample(frame.serverTime, m_connection->getTime().asSeconds());
+
+        //positions are interpolated straight away
+        for (const auto& entry : frame.snapshot.entries)
+        {
+            if (auto entity = getSlotEntity(entry.slot))
+            {
+                entity->getComponent<NetworkController>()->addSample(frame.serverTime, entry.position);
+            }
+        }
+
+        //frames usually arrive in order, but not always
+        auto result = std::find_if(m_spectatorFrames.rbegin(), m_spectatorFrames.rend(),
+            [&frame](const SpectatorFrame& f) { return f.serverTime <= frame.serverTime; });
+        m_spectatorFrames.insert(result.base(), std::move(frame));
+        if (m_spectatorFrames.size() > maxSpectatorFrames) m_spectatorFrames.pop_front();
+    }
+        break;
+    case PacketIdent::ServerSettings:
+        packet >> m_replicationMode;
+        break;
+    case PacketIdent::ReplicateProgram:
     {
         xy::ClientID id;
-        Direction direction;
-        packet >> id >> direction;
+        packet >> id;
 
-        XY_ASSERT(m_playerEntities.find(id) != m_playerEntities.end(), "Player ID does not exist");
-        m_playerEntities[id]->getComponent<PlayerDrawable>()->setDirection(direction);
+        std::vector<sf::Uint8> program;
+        if (!Blob::read(packet, program)) break;
 
-        auto particles = m_playerEntities[id]->getComponents<xy::ParticleSystem>();
-        for (auto& ps : particles) ps->stop();
-        switch (direction)
+        if (auto logic = getPlayerLogic(id))
+        {
+            logic->setProgram(program);
+        }
+    }
+        break;
+    case PacketIdent::ReplicateTransport:
+    {
+        xy::ClientID id;
+        TransportChange change;
+        sf::Uint32 tick;
+        packet >> id >> change >> tick;
+
+        auto logic = getPlayerLogic(id);
+        if (!logic) break;
+
+        switch (change)
         {
         default: break;
-        case Direction::Up:
-            m_playerEntities[id]->getComponent<xy::ParticleSystem>("particle_up")->start();
+        case TransportChange::Play:
+            logic->start();
+            logic->advanceTo(tick);
             break;
-        case Direction::Down:
-            m_playerEntities[id]->getComponent<xy::ParticleSystem>("particle_down")->start();
+        case TransportChange::Pause:
+            //we're usually a little behind the server so catch up first
+            logic->advanceTo(tick);
+            logic->pause();
+            if (logic->getTick() != tick) requestResync(id);
             break;
-        case Direction::Left:
-            m_playerEntities[id]->getComponent<xy::ParticleSystem>("particle_left")->start();
-            break;
-        case Direction::Right:
-            m_playerEntities[id]->getComponent<xy::ParticleSystem>("particle_right")->start();
+        case TransportChange::Rewind:
+            logic->pause();
+            logic->rewind();
             break;
         }
     }
         break;
+    case PacketIdent::TransportSpeedChanged:
+    {
+        xy::ClientID id;
+        TransportSpeed speed;
+        sf::Uint32 tick;
+        packet >> id >> speed >> tick;
+
+        auto entity = getPlayerEntity(id);
+        if (!entity) break;
+        entity->getComponent<NetworkController>()->setSpeed(speed);
+
+        //we can't keep up with the server at max speed, so run as fast as
+        //we reasonably can and catch up whenever it tells us where it is
+        auto logic = entity->getComponent<PlayerLogic>();
+        logic->advanceTo(tick);
+        logic->setSpeed(speed == TransportSpeed::Max ? TransportSpeed::Octuple : speed);
+        REPORT("Playback Speed", std::to_string(static_cast<int>(getSpeedMultiplier(speed))));
+    }
+        break;
+    case PacketIdent::StateChecksum:
+    {
+        xy::ClientID id;
+        sf::Uint32 tick, hash;
+        packet >> id >> tick >> hash;
+
+        auto logic = getPlayerLogic(id);
+        if (logic && getPlayerEntity(id)->getComponent<NetworkController>()->getSpeed() == TransportSpeed::Max)
+        {
+            logic->advanceTo(tick);
+        }
+        if (logic && logic->verify(tick, hash) == PlayerLogic::Checkpoint::Mismatch)
+        {
+            requestResync(id);
+        }
+    }
+        break;
+    case PacketIdent::PlayerState:
+    {
+        xy::ClientID id;
+        float serverTime = 0.f;
+        PlayerLogic::State state;
+        packet >> id >> serverTime >> state;
+
+        if (isLocalPlayer(id))
+        {
+            correctPrediction(serverTime, state);
+        }
+        else if (auto logic = getPlayerLogic(id))
+        {
+            logic->setState(state);
+        }
+        m_resyncRequests.erase(id);
+    }
+        break;
+    case PacketIdent::DirectionUpdate:
+    {
+        xy::ClientID id;
+        Direction direction;
+        packet >> id >> direction;
+        //spectators get directions with their delayed snapshots,
+        //and our own mower turns when our simulation says so
+        auto entity = getPlayerEntity(id);
+        if (!m_spectating && entity && entity != m_localPlayer) setPlayerDirection(*entity, direction);
+    }
+        break;
+    case PacketIdent::PlayerJoined:
+    {
+        xy::ClientID id;
+        sf::Uint16 slot;
+        std::string name;
+        packet >> id >> slot >> name;
+        spawnPlayer(id, slot);
+    }
+        break;
+    case PacketIdent::PlayerLeft:
+    {
+        xy::ClientID id;
+        packet >> id;
+        despawnPlayer(id);
+        m_resyncRequests.erase(id);
+    }
+        break;
     case PacketIdent::TransportStateChanged:
     {
         TransportStatus ts;
@@ -351,6 +614,22 @@ void GameState::handlePacket(xy::Network::PacketType type, sf::Packet& packet, x
         }
     }
         break;
+    case PacketIdent::Fragment:
+    case PacketIdent::FragmentStatus:
+    {
+        xy::ClientID id;
+        packet >> id;
+        m_bulkTransfer.handlePacket(type, packet);
+    }
+        break;
+    case PacketIdent::MessageBatch:
+        Batch::read(packet, [this](sf::Packet& message)
+        {
+            xy::PacketID id;
+            message >> id;
+            handlePacket(static_cast<xy::Network::PacketType>(id), message);
+        });
+        break;
     case PacketIdent::ProgramStatus:
     {
         ProgramState ps;
@@ -368,6 +647,21 @@ void GameState::handlePacket(xy::Network::PacketType type, sf::Packet& packet, x
         case ProgramState::Resend:
             sendProgram();
             break;
+        case ProgramState::Upload:
+            uploadProgram();
+            break;
+        case ProgramState::Rejected:
+            if (m_localPlayer)
+            {
+                //the server's mower never started, so put ours back too
+                auto logic = m_localPlayer->getComponent<PlayerLogic>();
+                logic->pause();
+                logic->rewind();
+                m_gameUI.setTransportStatus(TransportStatus::Stopped);
+            }
+            m_pendingProgram.clear();
+            LOG("Program was rejected by the server", xy::Logger::Type::Warning);
+            break;
         }
     }
         break;
@@ -375,19 +669,233 @@ void GameState::handlePacket(xy::Network::PacketType type, sf::Packet& packet, x
     }
 }
 
+void GameState::updateSpectating()
+{
+    while (!m_spectatorFrames.empty()
+        && m_spectatorFrames.front().serverTime <= m_interpolationClock.getRenderTime())
+    {
+        applySpectatorFrame(m_spectatorFrames.front());
+        m_spectatorFrames.pop_front();
+    }
+}
+
+void GameState::applySpectatorFrame(const SpectatorFrame& frame)
+{
+    for (const auto& entry : frame.snapshot.entries)
+    {
+        auto entity = getSlotEntity(entry.slot);
+        if (entity && entity->getComponent<PlayerDrawable>()->getDirection() != entry.direction)
+        {
+            setPlayerDirection(*entity, entry.direction);
+        }
+    }
+}
+
+void GameState::spawnPlayer(xy::ClientID id, sf::Uint16 slot)
+{
+    if (slot >= m_playerSlots.size()) m_playerSlots.resize(slot + 1);
+    if (m_playerSlots[slot].id == id) return;
+
+    //the server reuses slots, so anyone still here has gone
+    if (m_playerSlots[slot].entity) despawnPlayer(m_playerSlots[slot].id);
+
+    auto& playerSlot = m_playerSlots[slot];
+    playerSlot.id = id;
+    if (isLocalPlayer(id))
+    {
+        playerSlot.entity = m_localPlayer;
+        return;
+    }
+
+    if (m_playerPool.empty())
+    {
+        LOG("Player pool exhausted, creating another mower", xy::Logger::Type::Info);
+        m_playerPool.push_back(createPlayerEntity(false));
+    }
+    auto playerEnt = std::move(m_playerPool.back());
+    m_playerPool.pop_back();
+
+    playerEnt->setPosition(spawnPosition);
+    playerEnt->getComponent<NetworkController>()->reset();
+    auto logic = playerEnt->getComponent<PlayerLogic>();
+    logic->reset(spawnPosition);
+    logic->setClientID(id);
+    playerEnt->getComponent<PlayerDrawable>()->setDirection(Direction::Right);
+
+    playerSlot.entity = m_mapEntity->addChild(playerEnt);
+    m_clippings->addMower(*playerSlot.entity);
+}
+
+void GameState::despawnPlayer(xy::ClientID id)
+{
+    for (auto& slot : m_playerSlots)
+    {
+        if (slot.id != id) continue;
+
+        if (slot.entity && slot.entity != m_localPlayer)
+        {
+            m_clippings->removeMower(*slot.entity);
+            m_playerPool.push_back(m_mapEntity->removeChild(*slot.entity));
+        }
+        slot = PlayerSlot();
+    }
+}
+
+xy::Entity* GameState::getPlayerEntity(xy::ClientID id) const
+{
+    if (isLocalPlayer(id)) return m_localPlayer;
+
+    //only control messages look players up by ID, which are rare enough to search for
+    auto result = std::find_if(m_playerSlots.begin(), m_playerSlots.end(),
+        [id](const PlayerSlot& slot) { return slot.id == id; });
+    return (result == m_playerSlots.end()) ? nullptr : result->entity;
+}
+
+xy::Entity* GameState::getSlotEntity(sf::Uint16 slot) const
+{
+    return (slot < m_playerSlots.size()) ? m_playerSlots[slot].entity : nullptr;
+}
+
+void GameState::setPlayerDirection(xy::Entity& entity, Direction direction)
+{
+    //clippings follow the drawable's direction
+    entity.getComponent<PlayerDrawable>()->setDirection(direction);
+}
+
+bool GameState::isLocalPlayer(xy::ClientID id) const
+{
+    return m_localPlayer && id == m_connection->getClientID();
+}
+
+void GameState::predictTransport(TransportChange change)
+{
+    //the server only confirms changes a round trip later, so start straight
+    //away and let reconcile() sort out any difference in timing
+    auto logic = m_localPlayer->getComponent<PlayerLogic>();
+    switch (change)
+    {
+    default: break;
+    case TransportChange::Play:
+        logic->start();
+        break;
+    case TransportChange::Pause:
+        logic->pause();
+        break;
+    case TransportChange::Rewind:
+        logic->rewind();
+        break;
+    }
+}
+
+void GameState::reconcile(float serverTime, sf::Uint32 tick, sf::Uint32 hash)
+{
+    auto id = m_connection->getClientID();
+    auto logic = m_localPlayer->getComponent<PlayerLogic>();
+
+    //anything sent before the last correction is out of date
+    if (m_resyncRequests.count(id) || serverTime <= m_resyncTime) return;
+
+    if (logic->getTransportStatus() != TransportStatus::Playing)
+    {
+        //we stopped, or never started, somewhere other than the server did
+        if (tick != logic->getTick() || hash != logic->getStateHash()) requestResync(id);
+        return;
+    }
+
+    //we can't keep up at max speed, so catch up whenever the server tells us where it is
+    if (m_localPlayer->getComponent<NetworkController>()->getSpeed() == TransportSpeed::Max)
+    {
+        logic->advanceTo(tick);
+    }
+
+    //we're normally ahead, so this is compared against our history.
+    //hashes too old to check say nothing either way, so are skipped
+    if (logic->verify(tick, hash) == PlayerLogic::Checkpoint::Mismatch)
+    {
+        requestResync(id);
+    }
+}
+
+void GameState::correctPrediction(float serverTime, const PlayerLogic::State& state)
+{
+    auto logic = m_localPlayer->getComponent<PlayerLogic>();
+    auto predictedTick = logic->getTick();
+    auto predictedPosition = m_localPlayer->getPosition();
+    auto wasPlaying = (logic->getTransportStatus() == TransportStatus::Playing);
+
+    //the state is a round trip old, so run forward to where we'd got to
+    logic->setState(state);
+    if (wasPlaying) logic->advanceTo(predictedTick);
+    m_resyncTime = serverTime;
+
+    //keep drawing the mower where it was and let the offset fade out
+    m_predictionError += predictedPosition - m_localPlayer->getPosition();
+    if (xy::Util::Vector::lengthSquared(m_predictionError) > maxSmoothedError * maxSmoothedError)
+    {
+        m_predictionError = {};
+    }
+}
+
+PlayerLogic* GameState::getPlayerLogic(xy::ClientID id)
+{
+    auto entity = getPlayerEntity(id);
+    return entity ? entity->getComponent<PlayerLogic>() : nullptr;
+}
+
+void GameState::requestNextSpeed()
+{
+    if (!m_localPlayer) return;
+
+    auto speed = m_localPlayer->getComponent<NetworkController>()->getSpeed();
+    speed = static_cast<TransportSpeed>((static_cast<sf::Uint8>(speed) + 1) % static_cast<sf::Uint8>(TransportSpeed::Count));
+
+    sf::Packet packet;
+    packet << PacketIdent::TransportRequestSpeed << m_connection->getClientID() << speed;
+    m_connection->send(packet, true);
+}
+
+void GameState::requestResync(xy::ClientID id)
+{
+    //only ask once until the server replies, or the request times out
+    if (m_resyncRequests.count(id)) return;
+    m_resyncRequests[id] = m_connection->getTime().asSeconds();
+
+    LOG("Simulation for player " + std::to_string(id) + " out of sync, requesting state", xy::Logger::Type::Info);
+
+    sf::Packet packet;
+    packet << PacketIdent::ResyncRequest << m_connection->getClientID() << id;
+    m_connection->send(packet, true);
+}
+
 void GameState::sendProgram()
 {
-    auto program = m_gameUI.getProgram();
-    if (!program.empty())
+    m_pendingProgram = m_gameUI.getProgram();
+    if (m_pendingProgram.size() > MaxProgramSize)
     {
+        LOG("Program is too large to send", xy::Logger::Type::Error);
+        m_pendingProgram.clear();
+    }
+
+    if (!m_pendingProgram.empty())
+    {
+        //only the digest is sent to start with as the server
+        //probably has the program already if it was replayed
         sf::Packet packet;
         packet << PacketIdent::TransmitProgram;
-        packet << m_connection.getClientID();
-        packet << sf::Uint32(program.size());
-        for (auto data : program)
-        {
-            packet << data;
-        }
-        m_connection.send(packet, true);
+        packet << m_connection->getClientID();
+        packet << ProgramStore::digest(m_pendingProgram);
+        packet << sf::Uint32(m_pendingProgram.size());
+        m_connection->send(packet, true);
+    }
+}
+
+void GameState::uploadProgram()
+{
+    if (m_pendingProgram.empty()) return;
+
+    m_bulkTransfer.setClientID(m_connection->getClientID());
+    if (!m_bulkTransfer.send(BulkChannel::Program, m_pendingProgram))
+    {
+        LOG("Failed to queue program upload", xy::Logger::Type::Error);
     }
 }
\ No newline at end of file
@@ -37,7 +37,6 @@ source distribution.
 #include <xygine/App.hpp>
 #include <xygine/Reports.hpp>
 #include <xygine/components/SfDrawableComponent.hpp>
-#include <xygine/Resource.hpp>
 
 #include <RoundedRectangle.hpp>
 #include <components/ButtonLogic.hpp>
@@ -132,9 +131,8 @@ namespace
     }
 }
 
-GameUI::GameUI(xy::State::Context sc, xy::TextureResource& tr, xy::FontResource& fr, xy::Scene& scene)
-    : m_fontResource    (fr),
-    m_textureResource   (tr),
+GameUI::GameUI(xy::State::Context sc, AssetManager::Lease& assets, xy::Scene& scene)
+    : m_assets          (assets),
     m_transportStatus   (TransportStatus::Stopped),
     m_stateContext      (sc),
     m_scene             (scene),
@@ -192,7 +190,7 @@ GameUI::GameUI(xy::State::Context sc, xy::TextureResource& tr, xy::FontResource&
 
         auto text = std::make_unique<xy::SfDrawableComponent<sf::Text>>(m_messageBus);
         auto& td = text->getDrawable();
-        td.setFont(fr.get("assets/fonts/Console.ttf"));
+        td.setFont(assets.getFont("console"));
         td.setString(it->second);
         td.setFillColor(sf::Color::Black);
         xy::Util::Position::centreOrigin(td);
@@ -238,7 +236,7 @@ GameUI::GameUI(xy::State::Context sc, xy::TextureResource& tr, xy::FontResource&
     //add mouse cursor
     auto ad = xy::Component::create<xy::SfDrawableComponent<sf::Sprite>>(m_messageBus);
     auto& sprite = ad->getDrawable();
-    sprite.setTexture(tr.get("assets/images/ui/cursor.png"));
+    sprite.setTexture(assets.getTexture("cursor"));
 
     entity = xy::Entity::create(m_messageBus);
     entity->addComponent(ad);
@@ -277,7 +275,7 @@ GameUI::GameUI(xy::State::Context sc, xy::TextureResource& tr, xy::FontResource&
     entity->addCommandCategories(CommandCategory::TransportControl);
     entity->addComponent(rr);
 
-    auto texture = &tr.get("assets/images/transport.png");
+    auto texture = &assets.getTexture("transport");
 
     auto playButton = makeTransportButton(m_messageBus);
     playButton->setName("play_button");
@@ -652,7 +650,7 @@ void GameUI::addInstructionBlock(const sf::Vector2f& position, const sf::Vector2
 
     auto text = std::make_unique<xy::SfDrawableComponent<sf::Text>>(m_messageBus);
     auto& td = text->getDrawable();
-    td.setFont(m_fontResource.get("assets/fonts/Console.ttf"));
+    td.setFont(m_assets.getFont("console"));
     td.setString(instructionLabels[instruction]);
     td.setFillColor(sf::Color::Black);
     xy::Util::Position::centreOrigin(td);
@@ -679,7 +677,7 @@ void GameUI::addInstructionBlock(const sf::Vector2f& position, const sf::Vector2
      
         text = std::make_unique<xy::SfDrawableComponent<sf::Text>>(m_messageBus);
         auto& td = text->getDrawable();
-        td.setFont(m_fontResource.get("assets/fonts/Console.ttf"));
+        td.setFont(m_assets.getFont("console"));
         td.setString("1");
         xy::Util::Position::centreOrigin(td);
         text->setPosition(inputSize / 2.f);
@@ -694,7 +692,7 @@ void GameUI::addInstructionBlock(const sf::Vector2f& position, const sf::Vector2
     if (instruction == Instruction::Loop)
     {
         auto& child = entity->getChildren()[0];
-        auto loop = std::make_unique<LoopHandle>(m_messageBus, m_textureResource.get("assets/images/loop_handle.png"), labelSize.y + 22.f); //TODO get the padding value from stack
+        auto loop = std::make_unique<LoopHandle>(m_messageBus, m_assets.getTexture("loop_handle"), labelSize.y + 22.f); //TODO get the padding value from stack
         //loop->setEnabled(true);
         loop->setPosition(-(labelSize.x + inputBoxSpacing), 0.f);
         child->addComponent<LoopHandle>(loop);
@@ -711,7 +709,7 @@ void GameUI::showInputWindow(sf::Uint64 destId)
     entity->addCommandCategories(CommandCategory::InputPopup);
     auto inputWindow = std::make_unique<InputWindow>(m_messageBus);
     inputWindow->setTargetId(destId);
-    inputWindow->setFont(m_fontResource.get("assets/fonts/Console.ttf"));
+    inputWindow->setFont(m_assets.getFont("console"));
     inputWindow->setCharacterSize(80u);
     entity->addComponent<InputWindow>(inputWindow);
     m_scene.addEntity(entity, xy::Scene::Layer::FrontFront);
@@ -0,0 +1,136 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+#include <Hash.hpp>
+
+#include <algorithm>
+
+namespace
+{
+    const std::array<sf::Uint32, 64> roundConstants =
+    {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+    };
+
+    sf::Uint32 rotate(sf::Uint32 value, sf::Uint32 count)
+    {
+        return (value >> count) | (value << (32 - count));
+    }
+
+    void processBlock(std::array<sf::Uint32, 8>& state, const sf::Uint8* block)
+    {
+        std::array<sf::Uint32, 64> w;
+        for (std::size_t i = 0; i < 16; ++i)
+        {
+            w[i] = (sf::Uint32(block[i * 4]) << 24) | (sf::Uint32(block[i * 4 + 1]) << 16)
+                | (sf::Uint32(block[i * 4 + 2]) << 8) | sf::Uint32(block[i * 4 + 3]);
+        }
+        for (std::size_t i = 16; i < 64; ++i)
+        {
+            auto s0 = rotate(w[i - 15], 7) ^ rotate(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            auto s1 = rotate(w[i - 2], 17) ^ rotate(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        auto a = state[0], b = state[1], c = state[2], d = state[3];
+        auto e = state[4], f = state[5], g = state[6], h = state[7];
+        for (std::size_t i = 0; i < 64; ++i)
+        {
+            auto s1 = rotate(e, 6) ^ rotate(e, 11) ^ rotate(e, 25);
+            auto ch = (e & f) ^ (~e & g);
+            auto temp1 = h + s1 + ch + roundConstants[i] + w[i];
+            auto s0 = rotate(a, 2) ^ rotate(a, 13) ^ rotate(a, 22);
+            auto maj = (a & b) ^ (a & c) ^ (b & c);
+            auto temp2 = s0 + maj;
+
+            h = g;
+            g = f;
+            f = e;
+            e = d + temp1;
+            d = c;
+            c = b;
+            b = a;
+            a = temp1 + temp2;
+        }
+
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+    }
+}
+
+Hash::Sha256Digest Hash::sha256(const void* data, std::size_t size)
+{
+    std::array<sf::Uint32, 8> state =
+    {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+
+    const auto* bytes = static_cast<const sf::Uint8*>(data);
+    std::size_t offset = 0;
+    for (; offset + 64 <= size; offset += 64)
+    {
+        processBlock(state, bytes + offset);
+    }
+
+    //the remainder is padded with a single set bit, zeros
+    //and the message length in bits, over one or two blocks
+    std::array<sf::Uint8, 128> tail = {};
+    auto remainder = size - offset;
+    std::copy(bytes + offset, bytes + size, tail.begin());
+    tail[remainder] = 0x80;
+
+    std::size_t tailSize = (remainder < 56) ? 64 : 128;
+    auto bitCount = static_cast<sf::Uint64>(size) * 8;
+    for (std::size_t i = 0; i < 8; ++i)
+    {
+        tail[tailSize - 1 - i] = static_cast<sf::Uint8>(bitCount >> (i * 8));
+    }
+    for (std::size_t i = 0; i < tailSize; i += 64)
+    {
+        processBlock(state, tail.data() + i);
+    }
+
+    Sha256Digest digest;
+    for (std::size_t i = 0; i < state.size(); ++i)
+    {
+        digest[i * 4] = static_cast<sf::Uint8>(state[i] >> 24);
+        digest[i * 4 + 1] = static_cast<sf::Uint8>(state[i] >> 16);
+        digest[i * 4 + 2] = static_cast<sf::Uint8>(state[i] >> 8);
+        digest[i * 4 + 3] = static_cast<sf::Uint8>(state[i]);
+    }
+    return digest;
+}
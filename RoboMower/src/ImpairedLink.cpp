@@ -0,0 +1,281 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+#include <ImpairedLink.hpp>
+
+#include <xygine/Assert.hpp>
+
+#include <algorithm>
+
+namespace
+{
+    //UDP and IP headers count towards the bandwidth cap
+    const std::size_t headerSize = 28;
+    //unreliable packets are dropped rather than queued once the capped
+    //link is this far behind, as a router's buffer would
+    const sf::Time maxBacklog = sf::seconds(1.f);
+    //lost reliable packets are resent after a round trip, but no sooner than this
+    const sf::Time minResendTime = sf::milliseconds(50);
+    const std::size_t maxResends = 8;
+    //reordered packets are held back for up to this much on top of the latency
+    const float reorderHold = 20.f;
+
+    sf::Time milliseconds(float ms)
+    {
+        return sf::microseconds(static_cast<sf::Int64>(ms * 1000.f));
+    }
+}
+
+//---------------------------------------------------------
+NetworkImpairment::NetworkImpairment(const NetworkConditions& conditions)
+    : m_conditions  (conditions),
+    m_generator     (conditions.seed),
+    m_distribution  (0.f, 1.f)
+{
+
+}
+
+//public
+void NetworkImpairment::push(xy::ClientID id, const sf::Packet& packet, bool reliable)
+{
+    auto& stream = m_streams[id];
+    auto lost = lose(stream);
+    if (lost && !reliable) return;
+
+    auto now = m_clock.getElapsedTime();
+    auto departure = now;
+    if (m_conditions.bandwidth > 0.f)
+    {
+        departure = std::max(now, stream.linkFreeTime);
+        if (!reliable && departure - now > maxBacklog) return;
+
+        auto bits = static_cast<float>((packet.getDataSize() + headerSize) * 8);
+        stream.linkFreeTime = departure + sf::seconds(bits / (m_conditions.bandwidth * 1000.f));
+    }
+
+    Delayed delayed;
+    delayed.clientID = id;
+    delayed.reliable = reliable;
+    delayed.due = departure + delay();
+    delayed.packet = m_pool.acquire();
+    delayed.packet->append(packet.getData(), packet.getDataSize());
+
+    if (reliable)
+    {
+        //each loss costs a resend, and the resent packet may be lost too
+        auto resendTime = std::max(minResendTime, milliseconds(m_conditions.latency * 2.f));
+        for (auto i = 0u; lost && i < maxResends; ++i)
+        {
+            delayed.due += resendTime;
+            lost = lose(stream);
+        }
+        delayed.due = std::max(delayed.due, stream.lastReliableTime);
+        stream.lastReliableTime = delayed.due;
+    }
+    else
+    {
+        if (roll() < m_conditions.reordering)
+        {
+            delayed.due += milliseconds((m_conditions.latency + reorderHold) * (0.5f + roll() * 0.5f));
+        }
+
+        if (roll() < m_conditions.duplication)
+        {
+            Delayed duplicate;
+            duplicate.clientID = id;
+            duplicate.due = departure + delay();
+            //copied rather than shared, as links are free to modify what they send
+            duplicate.packet = m_pool.acquire();
+            duplicate.packet->append(packet.getData(), packet.getDataSize());
+            insert(std::move(duplicate));
+        }
+    }
+    insert(std::move(delayed));
+}
+
+void NetworkImpairment::flush(const SendFunc& send)
+{
+    auto now = m_clock.getElapsedTime();
+    while (!m_queue.empty() && m_queue.front().due <= now)
+    {
+        auto& delayed = m_queue.front();
+        send(delayed.clientID, *delayed.packet, delayed.reliable);
+        m_queue.pop_front();
+    }
+
+    //streams with nothing outstanding behave like new ones,
+    //so are dropped rather than kept for clients which have left
+    for (auto stream = m_streams.begin(); stream != m_streams.end();)
+    {
+        if (!stream->second.inLossBurst
+            && stream->second.linkFreeTime <= now
+            && stream->second.lastReliableTime <= now)
+        {
+            stream = m_streams.erase(stream);
+        }
+        else
+        {
+            ++stream;
+        }
+    }
+}
+
+void NetworkImpairment::clear()
+{
+    m_queue.clear();
+    m_streams.clear();
+}
+
+//private
+bool NetworkImpairment::lose(Stream& stream)
+{
+    if (m_conditions.loss <= 0.f) return false;
+
+    //two state model, so that losses come in bursts of the given average
+    //length while still adding up to the overall loss rate
+    auto burstLength = std::max(1.f, m_conditions.lossBurst);
+    if (stream.inLossBurst)
+    {
+        if (roll() < 1.f / burstLength) stream.inLossBurst = false;
+    }
+    else
+    {
+        auto loss = std::min(m_conditions.loss, 0.99f);
+        if (roll() < loss / (burstLength * (1.f - loss))) stream.inLossBurst = true;
+    }
+    return stream.inLossBurst;
+}
+
+sf::Time NetworkImpairment::delay()
+{
+    return milliseconds(m_conditions.latency + m_conditions.jitter * roll());
+}
+
+void NetworkImpairment::insert(Delayed&& delayed)
+{
+    //after any packets due at the same time, so that equal delays keep their order
+    auto result = std::upper_bound(m_queue.begin(), m_queue.end(), delayed.due,
+        [](sf::Time due, const Delayed& d) {return due < d.due; });
+    m_queue.insert(result, std::move(delayed));
+}
+
+//---------------------------------------------------------
+ImpairedClientLink::ImpairedClientLink(std::unique_ptr<ClientLink> link, const NetworkConditions& conditions)
+    : m_link    (std::move(link)),
+    m_impairment(conditions)
+{
+    XY_ASSERT(m_link, "Impaired link has nothing to wrap");
+    m_link->setPacketHandler([this](xy::Network::PacketType type, sf::Packet& packet)
+    {
+        if (m_packetHandler) m_packetHandler(type, packet);
+    });
+}
+
+//public
+void ImpairedClientLink::disconnect()
+{
+    m_impairment.clear();
+    m_link->disconnect();
+}
+
+void ImpairedClientLink::update(float dt)
+{
+    m_impairment.flush([this](xy::ClientID, sf::Packet& packet, bool reliable)
+    {
+        m_link->send(packet, reliable);
+    });
+    m_link->update(dt);
+}
+
+bool ImpairedClientLink::send(sf::Packet& packet, bool reliable)
+{
+    if (!m_link->connected()) return false;
+
+    m_impairment.push(xy::Network::NullID, packet, reliable);
+    return true;
+}
+
+//---------------------------------------------------------
+ImpairedServerLink::ImpairedServerLink(std::unique_ptr<ServerLink> link, const NetworkConditions& conditions)
+    : m_link    (std::move(link)),
+    m_conditions(conditions),
+    m_impairment(conditions),
+    m_clientCount(0)
+{
+    XY_ASSERT(m_link, "Impaired link has nothing to wrap");
+    m_link->setPacketHandler([this](xy::ClientID id, xy::Network::PacketType type, sf::Packet& packet)
+    {
+        if (m_packetHandler) m_packetHandler(id, type, packet);
+    });
+    m_link->setTimeoutHandler([this](xy::ClientID id)
+    {
+        if (m_timeoutHandler) m_timeoutHandler(id);
+    });
+}
+
+//public
+void ImpairedServerLink::stop()
+{
+    m_impairment.clear();
+    m_link->stop();
+}
+
+void ImpairedServerLink::update(float dt)
+{
+    m_impairment.flush([this](xy::ClientID id, sf::Packet& packet, bool reliable)
+    {
+        if (id == xy::Network::NullID)
+        {
+            m_link->broadcast(packet, reliable);
+        }
+        else
+        {
+            m_link->send(id, packet, reliable);
+        }
+    });
+    m_link->update(dt);
+}
+
+bool ImpairedServerLink::send(xy::ClientID id, sf::Packet& packet, bool reliable)
+{
+    m_impairment.push(id, packet, reliable);
+    return true;
+}
+
+void ImpairedServerLink::broadcast(sf::Packet& packet, bool reliable)
+{
+    m_impairment.push(xy::Network::NullID, packet, reliable);
+}
+
+std::unique_ptr<ClientLink> ImpairedServerLink::createLocalClient()
+{
+    auto conditions = m_conditions;
+    conditions.seed += ++m_clientCount;
+    return std::make_unique<ImpairedClientLink>(m_link->createLocalClient(), conditions);
+}
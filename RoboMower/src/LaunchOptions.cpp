@@ -0,0 +1,165 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+#include <LaunchOptions.hpp>
+
+#include <xygine/Log.hpp>
+
+#include <string>
+#include <cstdlib>
+
+namespace
+{
+    //returns true and sets value if arg is of the form name=value
+    bool getValue(const std::string& arg, const std::string& name, std::string& value)
+    {
+        if (arg.compare(0, name.size() + 1, name + "=") != 0) return false;
+        value = arg.substr(name.size() + 1);
+        return true;
+    }
+
+    //network conditions are given as --net-name=value. Rates are percentages
+    bool getCondition(const std::string& arg, const std::string& name, float scale, float& dest)
+    {
+        std::string value;
+        if (!getValue(arg, "--net-" + name, value)) return false;
+
+        char* end = nullptr;
+        auto result = std::strtof(value.c_str(), &end);
+        if (end != value.c_str() && result >= 0.f)
+        {
+            dest = result * scale;
+        }
+        else
+        {
+            LOG("Invalid network " + name + " " + value, xy::Logger::Type::Warning);
+        }
+        return true;
+    }
+}
+
+LaunchOptions LaunchOptions::parse(int argc, char** argv)
+{
+    LaunchOptions options;
+    for (auto i = 1; i < argc; ++i)
+    {
+        std::string arg(argv[i]);
+        std::string value;
+        if (arg == "--replication=events")
+        {
+            options.replicationMode = ReplicationMode::Events;
+        }
+        else if (arg == "--replication=snapshots")
+        {
+            options.replicationMode = ReplicationMode::Snapshots;
+        }
+        else if (arg == "--link=loopback")
+        {
+            options.link = Link::Loopback;
+        }
+        else if (arg == "--link=udp")
+        {
+            options.link = Link::Udp;
+        }
+        else if (arg == "--spectate")
+        {
+            options.spectate = true;
+        }
+        else if (getCondition(arg, "latency", 1.f, options.network.latency)
+            || getCondition(arg, "jitter", 1.f, options.network.jitter)
+            || getCondition(arg, "loss", 0.01f, options.network.loss)
+            || getCondition(arg, "loss-burst", 1.f, options.network.lossBurst)
+            || getCondition(arg, "duplicate", 0.01f, options.network.duplication)
+            || getCondition(arg, "reorder", 0.01f, options.network.reordering)
+            || getCondition(arg, "bandwidth", 1.f, options.network.bandwidth))
+        {
+            //value already applied
+        }
+        else if (getValue(arg, "--net-seed", value))
+        {
+            options.network.seed = static_cast<sf::Uint32>(std::strtoul(value.c_str(), nullptr, 10));
+        }
+        else if (getValue(arg, "--interp-delay", value))
+        {
+            char* end = nullptr;
+            auto delay = std::strtof(value.c_str(), &end);
+            if (end != value.c_str() && delay >= 0.f)
+            {
+                options.interpolationDelay = delay / 1000.f;
+            }
+            else
+            {
+                LOG("Invalid interpolation delay " + value, xy::Logger::Type::Warning);
+            }
+        }
+        else if (getValue(arg, "--profile", value))
+        {
+            options.profilerOutput = value;
+        }
+        else if (getValue(arg, "--profile-interval", value))
+        {
+            char* end = nullptr;
+            auto interval = std::strtof(value.c_str(), &end);
+            if (end != value.c_str() && interval > 0.f)
+            {
+                options.profilerInterval = interval;
+            }
+            else
+            {
+                LOG("Invalid profiler interval " + value, xy::Logger::Type::Warning);
+            }
+        }
+        else if (getValue(arg, "--record", value))
+        {
+            options.recordPath = value;
+        }
+        else if (getValue(arg, "--replay", value))
+        {
+            options.replayPath = value;
+        }
+        else if (getValue(arg, "--replay-speed", value))
+        {
+            char* end = nullptr;
+            auto speed = std::strtof(value.c_str(), &end);
+            if (end != value.c_str() && speed >= 0.f)
+            {
+                options.replaySpeed = speed;
+            }
+            else
+            {
+                LOG("Invalid replay speed " + value, xy::Logger::Type::Warning);
+            }
+        }
+        else
+        {
+            LOG("Unknown argument " + arg, xy::Logger::Type::Warning);
+        }
+    }
+    return options;
+}
\ No newline at end of file
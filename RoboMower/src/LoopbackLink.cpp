@@ -0,0 +1,310 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+#include <LoopbackLink.hpp>
+#include <SpscQueue.hpp>
+#include <PacketPool.hpp>
+
+#include <algorithm>
+#include <deque>
+
+using Queue = SpscQueue<PacketPool::Handle, 1024>;
+
+struct LoopbackChannel final
+{
+    //declared first so it outlives any packets queued below
+    std::shared_ptr<PacketPool> pool;
+
+    Queue serverBound;
+    Queue clientBound;
+
+    //packets which didn't fit in a full queue, each only used by the queue's producer
+    std::deque<PacketPool::Handle> serverBoundBacklog;
+    std::deque<PacketPool::Handle> clientBoundBacklog;
+
+    //only used by the server end
+    xy::ClientID clientID = xy::Network::NullID;
+};
+
+namespace
+{
+    //queued packets are never dropped, matching the guarantee of reliable sends
+    void flush(Queue& queue, std::deque<PacketPool::Handle>& backlog)
+    {
+        while (!backlog.empty() && queue.push(backlog.front()))
+        {
+            backlog.pop_front();
+        }
+    }
+
+    void push(Queue& queue, std::deque<PacketPool::Handle>& backlog, PacketPool::Handle handle)
+    {
+        flush(queue, backlog);
+        if (!backlog.empty() || !queue.push(handle))
+        {
+            backlog.push_back(std::move(handle));
+        }
+    }
+
+    //this is the only time a packet's data is copied. The receiver reads the
+    //queued packet itself, so each recipient needs its own, as reading moves
+    //the packet's read position
+    PacketPool::Handle copy(PacketPool& pool, const sf::Packet& packet)
+    {
+        auto handle = pool.acquire();
+        if (packet.getDataSize() > 0) handle->append(packet.getData(), packet.getDataSize());
+        return handle;
+    }
+
+    xy::Network::PacketType readType(sf::Packet& packet)
+    {
+        xy::PacketID type = xy::Network::HeartBeat;
+        packet >> type;
+        return static_cast<xy::Network::PacketType>(type);
+    }
+}
+
+//---------------------------------------------------------
+LoopbackClientLink::LoopbackClientLink(const std::shared_ptr<LoopbackChannel>& channel)
+    : m_channel (channel),
+    m_connected (false),
+    m_clientID  (xy::Network::NullID)
+{
+
+}
+
+LoopbackClientLink::~LoopbackClientLink()
+{
+    disconnect();
+}
+
+//public
+bool LoopbackClientLink::connect()
+{
+    auto packet = m_channel->pool->acquire();
+    *packet << xy::PacketID(xy::Network::Connect);
+    push(m_channel->serverBound, m_channel->serverBoundBacklog, std::move(packet));
+    return true;
+}
+
+void LoopbackClientLink::disconnect()
+{
+    if (!m_connected) return;
+
+    auto packet = m_channel->pool->acquire();
+    *packet << xy::PacketID(xy::Network::Disconnect);
+    push(m_channel->serverBound, m_channel->serverBoundBacklog, std::move(packet));
+    m_connected = false;
+}
+
+void LoopbackClientLink::update(float)
+{
+    flush(m_channel->serverBound, m_channel->serverBoundBacklog);
+
+    //handles are released before the next pop, which would otherwise
+    //swap them back into the queue rather than returning them to the pool
+    PacketPool::Handle handle;
+    for (; m_channel->clientBound.pop(handle); handle.reset())
+    {
+        auto& packet = *handle;
+        auto type = readType(packet);
+        switch (type)
+        {
+        default: break;
+        case xy::Network::Connect:
+        {
+            sf::Int64 time = 0;
+            packet >> m_clientID >> time;
+            m_connectTime = sf::microseconds(time);
+            m_clock.restart();
+            m_connected = true;
+        }
+            break;
+        case xy::Network::Disconnect:
+            m_connected = false;
+            break;
+        }
+
+        if (m_packetHandler) m_packetHandler(type, packet);
+    }
+}
+
+bool LoopbackClientLink::send(sf::Packet& packet, bool)
+{
+    if (!m_connected) return false;
+
+    push(m_channel->serverBound, m_channel->serverBoundBacklog, copy(*m_channel->pool, packet));
+    return true;
+}
+
+sf::Time LoopbackClientLink::getTime() const
+{
+    return m_connectTime + m_clock.getElapsedTime();
+}
+
+//---------------------------------------------------------
+LoopbackServerLink::LoopbackServerLink()
+    : m_pool        (std::make_shared<PacketPool>()),
+    m_maxClients    (16),
+    m_nextClientID  (0),
+    m_running       (false)
+{
+
+}
+
+LoopbackServerLink::~LoopbackServerLink()
+{
+    stop();
+}
+
+//public
+bool LoopbackServerLink::start()
+{
+    m_running = true;
+    m_clock.restart();
+    return true;
+}
+
+void LoopbackServerLink::stop()
+{
+    if (!m_running) return;
+
+    for (auto& channel : m_channels)
+    {
+        if (channel->clientID != xy::Network::NullID)
+        {
+            auto packet = m_pool->acquire();
+            *packet << xy::PacketID(xy::Network::Disconnect);
+            push(channel->clientBound, channel->clientBoundBacklog, std::move(packet));
+        }
+    }
+    m_channels.clear();
+    m_running = false;
+}
+
+void LoopbackServerLink::update(float)
+{
+    if (!m_running) return;
+
+    PacketPool::Handle handle;
+    for (auto& channel : m_channels)
+    {
+        flush(channel->clientBound, channel->clientBoundBacklog);
+
+        for (; channel->serverBound.pop(handle); handle.reset())
+        {
+            auto& packet = *handle;
+            auto type = readType(packet);
+            switch (type)
+            {
+            default: break;
+            case xy::Network::Connect:
+            {
+                if (channel->clientID != xy::Network::NullID) continue;
+
+                auto response = m_pool->acquire();
+                if (connectedCount() >= m_maxClients)
+                {
+                    *response << xy::PacketID(xy::Network::ServerFull);
+                    push(channel->clientBound, channel->clientBoundBacklog, std::move(response));
+                    continue;
+                }
+
+                channel->clientID = m_nextClientID++;
+                *response << xy::PacketID(xy::Network::Connect) << channel->clientID << m_clock.getElapsedTime().asMicroseconds();
+                push(channel->clientBound, channel->clientBoundBacklog, std::move(response));
+            }
+                break;
+            case xy::Network::Disconnect:
+                if (channel->clientID == xy::Network::NullID) continue;
+                break;
+            }
+
+            //ignore anything from clients which haven't connected
+            if (channel->clientID == xy::Network::NullID) continue;
+            if (m_packetHandler) m_packetHandler(channel->clientID, type, packet);
+            if (type == xy::Network::Disconnect) channel->clientID = xy::Network::NullID;
+        }
+
+        //the client was destroyed without disconnecting
+        if (channel.use_count() == 1 && channel->clientID != xy::Network::NullID)
+        {
+            if (m_timeoutHandler) m_timeoutHandler(channel->clientID);
+            channel->clientID = xy::Network::NullID;
+        }
+    }
+
+    m_channels.erase(std::remove_if(m_channels.begin(), m_channels.end(),
+        [](const std::shared_ptr<LoopbackChannel>& channel)
+    {
+        return channel.use_count() == 1;
+    }), m_channels.end());
+}
+
+bool LoopbackServerLink::send(xy::ClientID id, sf::Packet& packet, bool)
+{
+    auto result = std::find_if(m_channels.begin(), m_channels.end(),
+        [id](const std::shared_ptr<LoopbackChannel>& channel)
+    {
+        return channel->clientID == id;
+    });
+    if (result == m_channels.end()) return false;
+
+    push((*result)->clientBound, (*result)->clientBoundBacklog, copy(*m_pool, packet));
+    return true;
+}
+
+void LoopbackServerLink::broadcast(sf::Packet& packet, bool)
+{
+    for (auto& channel : m_channels)
+    {
+        if (channel->clientID != xy::Network::NullID)
+        {
+            push(channel->clientBound, channel->clientBoundBacklog, copy(*m_pool, packet));
+        }
+    }
+}
+
+std::unique_ptr<ClientLink> LoopbackServerLink::createLocalClient()
+{
+    auto channel = std::make_shared<LoopbackChannel>();
+    channel->pool = m_pool;
+    m_channels.push_back(channel);
+    return std::make_unique<LoopbackClientLink>(channel);
+}
+
+//private
+std::size_t LoopbackServerLink::connectedCount() const
+{
+    return std::count_if(m_channels.begin(), m_channels.end(),
+        [](const std::shared_ptr<LoopbackChannel>& channel)
+    {
+        return channel->clientID != xy::Network::NullID;
+    });
+}
@@ -36,14 +36,15 @@ namespace
     const std::string version("version 0.0.1");
 }
 
-MenuBackgroundState::MenuBackgroundState(xy::StateStack& stack, Context context)
+MenuBackgroundState::MenuBackgroundState(xy::StateStack& stack, Context context, AssetManager& assets)
     : State         (stack, context),
     m_messageBus    (context.appInstance.getMessageBus()),
+    m_assets        (assets),
     m_uiContainer   (m_messageBus)
 {
     context.appInstance.setMouseCursorVisible(false);
 
-    m_texts.emplace_back(version, m_fontResource.get("assets/fonts/VeraMono.ttf"), 18u);
+    m_texts.emplace_back(version, m_assets.getFont("vera_mono"), 18u);
     m_texts.back().setPosition(10.f, 1050.f);
 }
 
@@ -38,12 +38,13 @@ source distribution.
 #include <SFML/Window/Mouse.hpp>
 
 
-MenuJoinState::MenuJoinState(xy::StateStack& stack, Context context)
+MenuJoinState::MenuJoinState(xy::StateStack& stack, Context context, AssetManager& assets)
     : State         (stack, context),
     m_messageBus    (context.appInstance.getMessageBus()),
+    m_assets        (assets),
     m_uiContainer   (m_messageBus)
 {
-    m_cursorSprite.setTexture(m_textureResource.get("assets/images/ui/cursor.png"));
+    m_cursorSprite.setTexture(m_assets.getTexture("cursor"));
     m_cursorSprite.setPosition(context.renderWindow.mapPixelToCoords(sf::Mouse::getPosition(context.renderWindow)));
     buildMenu();
 
@@ -86,7 +87,7 @@ void MenuJoinState::handleMessage(const xy::Message& msg)
 //private
 void MenuJoinState::buildMenu()
 {
-    const auto& font = m_fontResource.get("flaps");
+    const auto& font = m_assets.getFont("default");
 
     auto textbox = std::make_shared<xy::UI::TextBox>(font);
     textbox->setLabelText("IP Address:");
@@ -100,7 +101,7 @@ void MenuJoinState::buildMenu()
     m_statusLabel->setPosition(960.f, 590.f);
     m_uiContainer.addControl(m_statusLabel);
 
-    auto joinButton = std::make_shared<xy::UI::Button>(font, m_textureResource.get("assets/images/ui/button.png"));
+    auto joinButton = std::make_shared<xy::UI::Button>(font, m_assets.getTexture("button"));
     joinButton->setText("Join");
     joinButton->setAlignment(xy::UI::Alignment::Centre);
     joinButton->setPosition(840.f, 770.f);
@@ -110,7 +111,7 @@ void MenuJoinState::buildMenu()
     });
     m_uiContainer.addControl(joinButton);
 
-    auto backButton = std::make_shared<xy::UI::Button>(font, m_textureResource.get("assets/images/ui/button.png"));
+    auto backButton = std::make_shared<xy::UI::Button>(font, m_assets.getTexture("button"));
     backButton->setText("Back");
     backButton->setAlignment(xy::UI::Alignment::Centre);
     backButton->setPosition(1080.f, 770.f);
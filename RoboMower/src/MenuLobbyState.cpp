@@ -41,13 +41,14 @@ namespace
     const float tickRate = 1.f / 20.f;
 }
 
-MenuLobbyState::MenuLobbyState(xy::StateStack& stack, Context context)
+MenuLobbyState::MenuLobbyState(xy::StateStack& stack, Context context, AssetManager& assets)
     : State                 (stack, context),
     m_messageBus            (context.appInstance.getMessageBus()),
+    m_assets                (assets),
     m_uiContainer           (m_messageBus),
-    m_font                  (m_fontResource.get("dfg")) 
+    m_font                  (m_assets.getFont("default")) 
 {
-    m_cursorSprite.setTexture(m_textureResource.get("assets/images/ui/cursor.png"));
+    m_cursorSprite.setTexture(m_assets.getTexture("cursor"));
     m_cursorSprite.setPosition(context.renderWindow.mapPixelToCoords(sf::Mouse::getPosition(context.renderWindow)));
     buildMenu();
 
@@ -97,9 +98,9 @@ void MenuLobbyState::handleMessage(const xy::Message&)
 //private
 void MenuLobbyState::buildMenu()
 {
-    const auto& font = m_fontResource.get("flaps");
+    const auto& font = m_assets.getFont("default");
     
-    auto startButton = std::make_shared<xy::UI::Button>(font, m_textureResource.get("assets/images/ui/button.png"));
+    auto startButton = std::make_shared<xy::UI::Button>(font, m_assets.getTexture("button"));
     startButton->setText("Start");
     startButton->setAlignment(xy::UI::Alignment::Centre);
     startButton->setPosition(840.f, 770.f);
@@ -109,7 +110,7 @@ void MenuLobbyState::buildMenu()
     });
     m_uiContainer.addControl(startButton);
 
-    auto backButton = std::make_shared<xy::UI::Button>(font, m_textureResource.get("assets/images/ui/button.png"));
+    auto backButton = std::make_shared<xy::UI::Button>(font, m_assets.getTexture("button"));
     backButton->setText("Back");
     backButton->setAlignment(xy::UI::Alignment::Centre);
     backButton->setPosition(1080.f, 770.f);
@@ -35,13 +35,14 @@ source distribution.
 
 #include <SFML/Window/Mouse.hpp>
 
-MenuMainState::MenuMainState(xy::StateStack& stack, Context context)
+MenuMainState::MenuMainState(xy::StateStack& stack, Context context, AssetManager& assets)
     : State     (stack, context),
     m_messageBus(context.appInstance.getMessageBus()),
+    m_assets    (assets),
     m_uiContainer(m_messageBus)
 {
     context.appInstance.setMouseCursorVisible(false);
-    m_cursorSprite.setTexture(m_textureResource.get("assets/images/ui/cursor.png"));
+    m_cursorSprite.setTexture(m_assets.getTexture("cursor"));
     m_cursorSprite.setPosition(context.renderWindow.mapPixelToCoords(sf::Mouse::getPosition(context.renderWindow)));
 
     buildMenu();
@@ -87,9 +88,9 @@ void MenuMainState::handleMessage(const xy::Message& msg)
 //private
 void MenuMainState::buildMenu()
 {
-    const auto& font = m_fontResource.get("assets/fonts/VeraMono.ttf");
+    const auto& font = m_assets.getFont("vera_mono");
     
-    auto button = std::make_shared<xy::UI::Button>(font, m_textureResource.get("assets/images/ui/start_button.png"));
+    auto button = std::make_shared<xy::UI::Button>(font, m_assets.getTexture("start_button"));
     button->setText("Single Player");
     button->setAlignment(xy::UI::Alignment::Centre);
     button->setPosition(960.f, 475.f);
@@ -106,7 +107,7 @@ void MenuMainState::buildMenu()
     });
     m_uiContainer.addControl(button);
 
-    button = std::make_shared<xy::UI::Button>(font, m_textureResource.get("assets/images/ui/start_button.png"));
+    button = std::make_shared<xy::UI::Button>(font, m_assets.getTexture("start_button"));
     button->setText("Host Multiplayer");
     button->setAlignment(xy::UI::Alignment::Centre);
     button->setPosition(960.f, 575.f);
@@ -116,7 +117,7 @@ void MenuMainState::buildMenu()
     });
     m_uiContainer.addControl(button);
 
-    button = std::make_shared<xy::UI::Button>(font, m_textureResource.get("assets/images/ui/start_button.png"));
+    button = std::make_shared<xy::UI::Button>(font, m_assets.getTexture("start_button"));
     button->setText("Join Multiplayer");
     button->setAlignment(xy::UI::Alignment::Centre);
     button->setPosition(960.f, 675.f);
@@ -126,7 +127,7 @@ void MenuMainState::buildMenu()
     });
     m_uiContainer.addControl(button);
 
-    button = std::make_shared<xy::UI::Button>(font, m_textureResource.get("assets/images/ui/start_button.png"));
+    button = std::make_shared<xy::UI::Button>(font, m_assets.getTexture("start_button"));
     button->setText("Options");
     button->setAlignment(xy::UI::Alignment::Centre);
     button->setPosition(960.f, 775.f);
@@ -137,7 +138,7 @@ void MenuMainState::buildMenu()
     });
     m_uiContainer.addControl(button);
 
-    button = std::make_shared<xy::UI::Button>(font, m_textureResource.get("assets/images/ui/start_button.png"));
+    button = std::make_shared<xy::UI::Button>(font, m_assets.getTexture("start_button"));
     button->setText("Quit");
     button->setAlignment(xy::UI::Alignment::Centre);
     button->setPosition(960.f, 875.f);
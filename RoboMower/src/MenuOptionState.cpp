@@ -45,9 +45,10 @@ namespace
     
 }
 
-MenuOptionState::MenuOptionState(xy::StateStack& stateStack, Context context)
+MenuOptionState::MenuOptionState(xy::StateStack& stateStack, Context context, AssetManager& assets)
     : State         (stateStack, context),
     m_messageBus    (context.appInstance.getMessageBus()),
+    m_assets        (assets),
     m_uiContainer   (m_messageBus)
 {
     //m_menuSprite.setTexture(context.appInstance.getTexture("assets/images/main_menu.png"));
@@ -55,10 +56,10 @@ MenuOptionState::MenuOptionState(xy::StateStack& stateStack, Context context)
     //Util::Position::centreOrigin(m_menuSprite);
     //m_menuSprite.move(0.f, -40.f);
 
-    m_cursorSprite.setTexture(m_textureResource.get("assets/images/ui/cursor.png"));
+    m_cursorSprite.setTexture(m_assets.getTexture("cursor"));
     m_cursorSprite.setPosition(context.renderWindow.mapPixelToCoords(sf::Mouse::getPosition(context.renderWindow)));
     
-    const auto& font = m_fontResource.get("assets/fonts/N_E_B.ttf");
+    const auto& font = m_assets.getFont("default");
     buildMenu(font);
 
     auto msg = m_messageBus.post<xy::Message::UIEvent>(xy::Message::UIMessage);
@@ -148,7 +149,7 @@ void MenuOptionState::handleMessage(const xy::Message& msg)
 //private
 void MenuOptionState::buildMenu(const sf::Font& font)
 {
-    auto soundSlider = std::make_shared<xy::UI::Slider>(font, m_textureResource.get("assets/images/ui/slider_handle.png"), 375.f);
+    auto soundSlider = std::make_shared<xy::UI::Slider>(font, m_assets.getTexture("slider_handle"), 375.f);
     soundSlider->setPosition(600.f, 470.f);
     soundSlider->setText("Volume");
     soundSlider->setMaxValue(1.f);
@@ -163,7 +164,7 @@ void MenuOptionState::buildMenu(const sf::Font& font)
     soundSlider->setValue(getContext().appInstance.getAudioSettings().volume); //set this *after* callback is set
     m_uiContainer.addControl(soundSlider);
 
-    auto muteCheckbox = std::make_shared<xy::UI::CheckBox>(font, m_textureResource.get("assets/images/ui/checkbox.png"));
+    auto muteCheckbox = std::make_shared<xy::UI::CheckBox>(font, m_assets.getTexture("checkbox"));
     muteCheckbox->setPosition(1070.f, 430.f);
     muteCheckbox->setText("Mute");
     muteCheckbox->addCallback([this](const xy::UI::CheckBox* checkBox)
@@ -175,7 +176,7 @@ void MenuOptionState::buildMenu(const sf::Font& font)
     m_uiContainer.addControl(muteCheckbox);
 
 
-    auto resolutionBox = std::make_shared<xy::UI::Selection>(font, m_textureResource.get("assets/images/ui/scroll_arrow.png"), 375.f);
+    auto resolutionBox = std::make_shared<xy::UI::Selection>(font, m_assets.getTexture("scroll_arrow"), 375.f);
     resolutionBox->setPosition(600.f, 510.f);
 
     const auto& modes = getContext().appInstance.getVideoSettings().AvailableVideoModes;
@@ -196,7 +197,7 @@ void MenuOptionState::buildMenu(const sf::Font& font)
 
     m_uiContainer.addControl(resolutionBox);
 
-    auto fullscreenCheckbox = std::make_shared<xy::UI::CheckBox>(font, m_textureResource.get("assets/images/ui/checkbox.png"));
+    auto fullscreenCheckbox = std::make_shared<xy::UI::CheckBox>(font, m_assets.getTexture("checkbox"));
     fullscreenCheckbox->setPosition(1070.f, 510.f);
     fullscreenCheckbox->setText("Full Screen");
     fullscreenCheckbox->addCallback([this](const xy::UI::CheckBox*)
@@ -206,7 +207,7 @@ void MenuOptionState::buildMenu(const sf::Font& font)
     fullscreenCheckbox->check((getContext().appInstance.getVideoSettings().WindowStyle & sf::Style::Fullscreen) != 0);
     m_uiContainer.addControl(fullscreenCheckbox);
 
-    auto difficultySelection = std::make_shared<xy::UI::Selection>(font, m_textureResource.get("assets/images/ui/scroll_arrow.png"), 375.f);
+    auto difficultySelection = std::make_shared<xy::UI::Selection>(font, m_assets.getTexture("scroll_arrow"), 375.f);
     difficultySelection->setPosition(600.f, 590.f);
     difficultySelection->addItem("Easy", static_cast<int>(xy::Difficulty::Easy));
     difficultySelection->addItem("Medium", static_cast<int>(xy::Difficulty::Medium));
@@ -222,7 +223,7 @@ void MenuOptionState::buildMenu(const sf::Font& font)
     difficultySelection->selectItem(static_cast<int>(getContext().appInstance.getGameSettings().difficulty));
     m_uiContainer.addControl(difficultySelection);
 
-    auto controllerCheckbox = std::make_shared<xy::UI::CheckBox>(font, m_textureResource.get("assets/images/ui/checkbox.png"));
+    auto controllerCheckbox = std::make_shared<xy::UI::CheckBox>(font, m_assets.getTexture("checkbox"));
     controllerCheckbox->setPosition(1070.f, 590.f);
     controllerCheckbox->setText("Enable Controller");
     controllerCheckbox->addCallback([this](const xy::UI::CheckBox* checkBox)
@@ -234,7 +235,7 @@ void MenuOptionState::buildMenu(const sf::Font& font)
     controllerCheckbox->check(getContext().appInstance.getGameSettings().controllerEnabled);
     m_uiContainer.addControl(controllerCheckbox);
 
-    auto applyButton = std::make_shared<xy::UI::Button>(font, m_textureResource.get("assets/images/ui/button.png"));
+    auto applyButton = std::make_shared<xy::UI::Button>(font, m_assets.getTexture("button"));
     applyButton->setText("Apply");
     applyButton->setAlignment(xy::UI::Alignment::Centre);
     applyButton->setPosition(840.f, 770.f);
@@ -253,7 +254,7 @@ void MenuOptionState::buildMenu(const sf::Font& font)
     });
     m_uiContainer.addControl(applyButton);
 
-    auto backButton = std::make_shared<xy::UI::Button>(font, m_textureResource.get("assets/images/ui/button.png"));
+    auto backButton = std::make_shared<xy::UI::Button>(font, m_assets.getTexture("button"));
     backButton->setText("Back");
     backButton->setAlignment(xy::UI::Alignment::Centre);
     backButton->setPosition(1080.f, 770.f);
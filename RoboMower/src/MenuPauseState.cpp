@@ -36,12 +36,13 @@ source distribution.
 
 #include <SFML/Window/Mouse.hpp>
 
-MenuPauseState::MenuPauseState(xy::StateStack& stack, Context context)
+MenuPauseState::MenuPauseState(xy::StateStack& stack, Context context, AssetManager& assets)
     : State     (stack, context),
     m_messageBus(context.appInstance.getMessageBus()),
+    m_assets    (assets),
     m_uiContainer(m_messageBus)
 {
-    const auto& font = m_fontResource.get("flaps");
+    const auto& font = m_assets.getFont("default");
     
     buildMenu(font);
 
@@ -49,7 +50,7 @@ MenuPauseState::MenuPauseState(xy::StateStack& stack, Context context)
     xy::Util::Position::centreOrigin(m_texts.back());
     m_texts.back().setPosition(960.f, 200.f);
 
-    m_cursorSprite.setTexture(m_textureResource.get("assets/images/ui/cursor.png"));
+    m_cursorSprite.setTexture(m_assets.getTexture("cursor"));
     m_cursorSprite.setPosition(context.renderWindow.mapPixelToCoords(sf::Mouse::getPosition(context.renderWindow)));
 
     auto msg = m_messageBus.post<xy::Message::UIEvent>(xy::Message::UIMessage);
@@ -92,7 +93,7 @@ void MenuPauseState::handleMessage(const xy::Message&){}
 //private
 void MenuPauseState::buildMenu(const sf::Font& font)
 {
-    auto button = std::make_shared<xy::UI::Button>(font, m_textureResource.get("assets/images/ui/start_button.png"));
+    auto button = std::make_shared<xy::UI::Button>(font, m_assets.getTexture("start_button"));
     button->setText("Continue");
     button->setAlignment(xy::UI::Alignment::Centre);
     button->setPosition(960.f, 475.f);
@@ -103,7 +104,7 @@ void MenuPauseState::buildMenu(const sf::Font& font)
     });
     m_uiContainer.addControl(button);
 
-    button = std::make_shared<xy::UI::Button>(font, m_textureResource.get("assets/images/ui/start_button.png"));
+    button = std::make_shared<xy::UI::Button>(font, m_assets.getTexture("start_button"));
     button->setText("Options");
     button->setAlignment(xy::UI::Alignment::Centre);
     button->setPosition(960.f, 575.f);
@@ -116,7 +117,7 @@ void MenuPauseState::buildMenu(const sf::Font& font)
     });
     m_uiContainer.addControl(button);
 
-    button = std::make_shared<xy::UI::Button>(font, m_textureResource.get("assets/images/ui/start_button.png"));
+    button = std::make_shared<xy::UI::Button>(font, m_assets.getTexture("start_button"));
     button->setText("Quit");
     button->setAlignment(xy::UI::Alignment::Centre);
     button->setPosition(960.f, 675.f);
@@ -32,29 +32,185 @@ source distribution.
 #include <xygine/Entity.hpp>
 #include <xygine/util/Vector.hpp>
 
-NetworkController::NetworkController(xy::MessageBus& mb)
-    : xy::Component(mb, this)
+#include <algorithm>
+
+namespace
+{
+    //anything further than this at normal speed is a teleport, eg a rewind
+    const float snapDistance = 64.f;
+
+    const float minInterval = 1.f / 60.f;
+    //the slowest rate the server sends at. Longer gaps are when nothing moved
+    const float maxInterval = 0.25f;
+
+    //delay enough to cover a lost update at the current rate
+    const float intervalDelay = 2.f;
+    const float delayEaseRate = 2.f;
+    //lets the offset recover if one update arrived unusually quickly
+    const float offsetDrift = 0.01f;
+
+    //how long entities carry on moving once they run out of updates
+    const float maxExtrapolation = 0.1f;
+    //gaps this many intervals long mean the server stopped sending because the
+    //entity stood still, rather than updates being lost along the way
+    const float idleIntervals = 3.f;
+}
+
+InterpolationClock::InterpolationClock()
+    : m_offset      (0.f),
+    m_hasOffset     (false),
+    m_lastServerTime(0.f),
+    m_interval      (0.05f),
+    m_minDelay      (0.1f),
+    m_delay         (0.1f),
+    m_renderTime    (0.f)
 {
 
 }
 
 //public
-void NetworkController::entityUpdate(xy::Entity& entity, float dt)
+void InterpolationClock::addSample(float serverTime, float localTime)
 {
-    auto movement = m_destination - entity.getPosition();
-    if (xy::Util::Vector::lengthSquared(movement) > 1500.f)
+    auto offset = localTime - serverTime;
+    if (!m_hasOffset || offset < m_offset)
     {
-        entity.setPosition(m_destination);
+        m_offset = offset;
+        m_hasOffset = true;
     }
-    else
+
+    if (serverTime > m_lastServerTime)
     {
-        entity.move(movement * 0.1f);
+        auto interval = serverTime - m_lastServerTime;
+        if (interval <= maxInterval)
+        {
+            m_interval += (std::max(minInterval, interval) - m_interval) * 0.1f;
+        }
+        m_lastServerTime = serverTime;
     }
 }
 
-void NetworkController::setDestination(const sf::Vector2f& destination)
+void InterpolationClock::update(float localTime, float dt)
 {
-    m_destination = destination;
+    if (!m_hasOffset) return;
+
+    m_offset += dt * offsetDrift;
+
+    auto targetDelay = std::max(m_minDelay, m_interval * intervalDelay);
+    m_delay += (targetDelay - m_delay) * std::min(1.f, dt * delayEaseRate);
+
+    //never run backwards, or entities would jitter to and fro
+    m_renderTime = std::max(m_renderTime, localTime - m_offset - m_delay);
 }
 
-//private
\ No newline at end of file
+//---------------------------------------------------------
+NetworkController::NetworkController(xy::MessageBus& mb, const InterpolationClock& clock)
+    : xy::Component (mb, this),
+    m_clock         (clock),
+    m_sampleCount   (0),
+    m_speed         (TransportSpeed::Normal)
+{
+
+}
+
+//public
+void NetworkController::entityUpdate(xy::Entity& entity, float)
+{
+    if (m_sampleCount == 0) return;
+
+    //keep one sample behind the render time to interpolate from
+    auto time = m_clock.getRenderTime();
+    while (m_sampleCount > 2 && m_samples[1].time <= time)
+    {
+        pop();
+    }
+    entity.setPosition(getPosition(time));
+}
+
+void NetworkController::addSample(float serverTime, const sf::Vector2f& position)
+{
+    if (m_sampleCount > 0)
+    {
+        //hold the last position until just before this update, else
+        //we'd creep all the way from where we stopped
+        const auto& newest = m_samples[m_sampleCount - 1];
+        auto interval = m_clock.getInterval();
+        if (serverTime - newest.time > interval * idleIntervals)
+        {
+            Sample hold;
+            hold.time = serverTime - interval;
+            hold.position = newest.position;
+            insert(hold);
+        }
+    }
+
+    Sample sample;
+    sample.time = serverTime;
+    sample.position = position;
+    insert(sample);
+}
+
+void NetworkController::reset()
+{
+    m_sampleCount = 0;
+    m_speed = TransportSpeed::Normal;
+}
+
+//private
+void NetworkController::insert(const Sample& sample)
+{
+    //updates usually arrive in order, so search from the newest
+    auto i = m_sampleCount;
+    while (i > 0 && m_samples[i - 1].time > sample.time) --i;
+
+    if (i > 0 && m_samples[i - 1].time == sample.time)
+    {
+        m_samples[i - 1] = sample;
+        return;
+    }
+
+    if (m_sampleCount == m_samples.size())
+    {
+        //too old to be any use
+        if (i == 0) return;
+        pop();
+        --i;
+    }
+
+    std::move_backward(m_samples.begin() + i, m_samples.begin() + m_sampleCount, m_samples.begin() + m_sampleCount + 1);
+    m_samples[i] = sample;
+    m_sampleCount++;
+}
+
+void NetworkController::pop()
+{
+    std::move(m_samples.begin() + 1, m_samples.begin() + m_sampleCount, m_samples.begin());
+    m_sampleCount--;
+}
+
+sf::Vector2f NetworkController::getPosition(float time) const
+{
+    const auto& first = m_samples[0];
+    if (m_sampleCount == 1 || time <= first.time) return first.position;
+
+    //there's no telling how far a mower moves at max speed, so never snap
+    const auto& second = m_samples[1];
+    auto multiplier = getSpeedMultiplier(m_speed);
+    auto snap = snapDistance * multiplier;
+    if (multiplier > 0.f
+        && xy::Util::Vector::lengthSquared(second.position - first.position) > snap * snap)
+    {
+        return (time < second.time) ? first.position : second.position;
+    }
+
+    auto velocity = (second.position - first.position) / (second.time - first.time);
+    if (time < second.time)
+    {
+        return first.position + velocity * (time - first.time);
+    }
+
+    //ahead of the newest update, so carry on for a little while then ease
+    //back, as the server stops sending updates when an entity stops
+    auto over = time - second.time;
+    auto amount = (over < maxExtrapolation) ? over : std::max(0.f, 2.f * maxExtrapolation - over);
+    return second.position + velocity * amount;
+}
@@ -30,6 +30,12 @@ source distribution.
 #include <PacketEnums.hpp>
 #include <NetProtocol.hpp>
 
+#include <xygine/Assert.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
 //---------------------------------------------------------
 sf::Packet& operator << (sf::Packet& p, TransportStatus ts)
 {
@@ -57,6 +63,19 @@ sf::Packet& operator >> (sf::Packet& p, TransportChange& tc)
     return p;
 }
 //---------------------------------------------------------
+sf::Packet& operator << (sf::Packet& p, TransportSpeed ts)
+{
+    return p << sf::Uint8(ts);
+}
+
+sf::Packet& operator >> (sf::Packet& p, TransportSpeed& ts)
+{
+    sf::Uint8 a;
+    p >> a;
+    ts = (a < sf::Uint8(TransportSpeed::Count)) ? static_cast<TransportSpeed>(a) : TransportSpeed::Normal;
+    return p;
+}
+//---------------------------------------------------------
 sf::Packet& operator << (sf::Packet& p, Direction d)
 {
     return p << sf::Uint8(d);
@@ -83,6 +102,19 @@ sf::Packet& operator >> (sf::Packet& p, ProgramState& d)
     return p;
 }
 //---------------------------------------------------------
+sf::Packet& operator << (sf::Packet& p, ReplicationMode m)
+{
+    return p << sf::Uint8(m);
+}
+
+sf::Packet& operator >> (sf::Packet& p, ReplicationMode& m)
+{
+    sf::Uint8 mode;
+    p >> mode;
+    m = static_cast<ReplicationMode>(mode);
+    return p;
+}
+//---------------------------------------------------------
 sf::Packet& operator << (sf::Packet& p, PacketIdent id)
 {
     return p << xy::PacketID(id);
@@ -95,4 +127,211 @@ sf::Packet& operator >> (sf::Packet& p, PacketIdent& id)
     id = static_cast<PacketIdent>(a);
     return p;
 }
-//---------------------------------------------------------
\ No newline at end of file
+//---------------------------------------------------------
+BitWriter::BitWriter()
+    : m_scratch     (0),
+    m_scratchBits   (0),
+    m_bitCount      (0)
+{
+
+}
+
+void BitWriter::write(sf::Uint32 value, sf::Uint8 bitCount)
+{
+    XY_ASSERT(bitCount <= 32, "Too many bits");
+    if (bitCount == 0) return;
+
+    if (bitCount < 32) value &= ((1u << bitCount) - 1u);
+    m_scratch |= (static_cast<sf::Uint64>(value) << m_scratchBits);
+    m_scratchBits += bitCount;
+    m_bitCount += bitCount;
+
+    while (m_scratchBits >= 8)
+    {
+        m_data.push_back(static_cast<sf::Uint8>(m_scratch & 0xff));
+        m_scratch >>= 8;
+        m_scratchBits -= 8;
+    }
+}
+
+void BitWriter::writeRanged(sf::Int32 value, sf::Int32 min, sf::Int32 max)
+{
+    XY_ASSERT(max > min, "Invalid range");
+    value = std::max(min, std::min(max, value));
+    write(static_cast<sf::Uint32>(value - min), Bits::required(static_cast<sf::Uint32>(max - min)));
+}
+
+void BitWriter::writeQuantised(float value, float min, float max, float precision)
+{
+    XY_ASSERT(max > min && precision > 0, "Invalid range");
+    value = std::max(min, std::min(max, value));
+    auto range = static_cast<sf::Uint32>(std::ceil((max - min) / precision));
+    auto quantised = static_cast<sf::Uint32>(std::round((value - min) / precision));
+    write(std::min(quantised, range), Bits::required(range));
+}
+
+void BitWriter::clear()
+{
+    m_data.clear();
+    m_scratch = 0;
+    m_scratchBits = 0;
+    m_bitCount = 0;
+}
+
+const std::vector<sf::Uint8>& BitWriter::getData()
+{
+    if (m_scratchBits > 0)
+    {
+        m_data.push_back(static_cast<sf::Uint8>(m_scratch & 0xff));
+        m_scratch = 0;
+        m_scratchBits = 0;
+        //round up so further writes start on a fresh byte
+        m_bitCount = m_data.size() * 8;
+    }
+    return m_data;
+}
+
+//---------------------------------------------------------
+BitReader::BitReader()
+    : m_data        (nullptr),
+    m_size          (0),
+    m_bitPosition   (0),
+    m_valid         (false)
+{
+
+}
+
+BitReader::BitReader(const void* data, std::size_t size)
+    : m_data        (static_cast<const sf::Uint8*>(data)),
+    m_size          (size),
+    m_bitPosition   (0),
+    m_valid         (data != nullptr || size == 0)
+{
+
+}
+
+sf::Uint32 BitReader::read(sf::Uint8 bitCount)
+{
+    XY_ASSERT(bitCount <= 32, "Too many bits");
+    if (!m_valid || m_bitPosition + bitCount > m_size * 8)
+    {
+        m_valid = false;
+        return 0;
+    }
+
+    sf::Uint64 value = 0;
+    sf::Uint8 bitsRead = 0;
+    while (bitsRead < bitCount)
+    {
+        auto byteIndex = m_bitPosition / 8;
+        auto bitOffset = m_bitPosition % 8;
+        auto count = std::min<std::size_t>(8 - bitOffset, bitCount - bitsRead);
+
+        sf::Uint64 bits = (m_data[byteIndex] >> bitOffset) & ((1u << count) - 1u);
+        value |= (bits << bitsRead);
+
+        bitsRead += static_cast<sf::Uint8>(count);
+        m_bitPosition += count;
+    }
+    return static_cast<sf::Uint32>(value);
+}
+
+sf::Int32 BitReader::readRanged(sf::Int32 min, sf::Int32 max)
+{
+    XY_ASSERT(max > min, "Invalid range");
+    return min + static_cast<sf::Int32>(read(Bits::required(static_cast<sf::Uint32>(max - min))));
+}
+
+float BitReader::readQuantised(float min, float max, float precision)
+{
+    XY_ASSERT(max > min && precision > 0, "Invalid range");
+    auto range = static_cast<sf::Uint32>(std::ceil((max - min) / precision));
+    return min + static_cast<float>(read(Bits::required(range))) * precision;
+}
+
+//---------------------------------------------------------
+sf::Uint8 Bits::required(sf::Uint32 range)
+{
+    sf::Uint8 count = 0;
+    while (range > 0)
+    {
+        count++;
+        range >>= 1;
+    }
+    return count;
+}
+
+sf::Packet& operator << (sf::Packet& p, BitWriter& writer)
+{
+    const auto& data = writer.getData();
+    XY_ASSERT(data.size() <= 0xffff, "Bit stream too large");
+    p << sf::Uint16(data.size());
+    if (!data.empty()) p.append(data.data(), data.size());
+    return p;
+}
+
+sf::Packet& operator >> (sf::Packet& p, BitReader& reader)
+{
+    //packets don't expose their read position, so relying on the block
+    //being at the end of the packet lets us find it without copying
+    sf::Uint16 size = 0;
+    if (p >> size && size <= p.getDataSize())
+    {
+        const auto* data = static_cast<const char*>(p.getData());
+        reader = BitReader(data + (p.getDataSize() - size), size);
+    }
+    else
+    {
+        reader = BitReader();
+    }
+    return p;
+}
+
+void Blob::write(sf::Packet& p, const std::vector<sf::Uint8>& data)
+{
+    XY_ASSERT(data.size() <= 0xffff, "Blob too large");
+    p << sf::Uint16(data.size());
+    if (!data.empty()) p.append(data.data(), data.size());
+}
+
+bool Blob::read(sf::Packet& p, std::vector<sf::Uint8>& data)
+{
+    sf::Uint16 size = 0;
+    if (!(p >> size) || size > p.getDataSize())
+    {
+        data.clear();
+        return false;
+    }
+
+    const auto* start = static_cast<const sf::Uint8*>(p.getData()) + (p.getDataSize() - size);
+    data.assign(start, start + size);
+    return true;
+}
+//---------------------------------------------------------
+//---------------------------------------------------------
+bool Batch::read(sf::Packet& p, const std::function<void(sf::Packet&)>& handler)
+{
+    sf::Uint8 count = 0;
+    p >> count;
+
+    std::array<sf::Uint16, MaxCount> sizes;
+    std::size_t total = 0;
+    for (auto i = 0u; i < count; ++i)
+    {
+        p >> sizes[i];
+        total += sizes[i];
+    }
+    if (!p || total > p.getDataSize()) return false;
+
+    //messages follow the sizes, at the end of the packet like a blob
+    const auto* data = static_cast<const char*>(p.getData()) + (p.getDataSize() - total);
+    sf::Packet message;
+    for (auto i = 0u; i < count; ++i)
+    {
+        message.clear();
+        message.append(data, sizes[i]);
+        data += sizes[i];
+        handler(message);
+    }
+    return true;
+}
@@ -0,0 +1,154 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+#include <PacketPool.hpp>
+
+#include <xygine/Assert.hpp>
+
+namespace
+{
+    //packets which grew this large, eg for bulk data, are
+    //shrunk on release so they don't pin lots of memory
+    const std::size_t maxRetainedSize = 8192;
+}
+
+PacketPool::Handle::Handle(const Handle& other)
+    : m_entry(other.m_entry)
+{
+    if (m_entry) m_entry->refCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+PacketPool::Handle& PacketPool::Handle::operator = (const Handle& other)
+{
+    if (other.m_entry) other.m_entry->refCount.fetch_add(1, std::memory_order_relaxed);
+    reset();
+    m_entry = other.m_entry;
+    return *this;
+}
+
+PacketPool::Handle::Handle(Handle&& other)
+    : m_entry(other.m_entry)
+{
+    other.m_entry = nullptr;
+}
+
+PacketPool::Handle& PacketPool::Handle::operator = (Handle&& other)
+{
+    if (this != &other)
+    {
+        reset();
+        m_entry = other.m_entry;
+        other.m_entry = nullptr;
+    }
+    return *this;
+}
+
+sf::Packet& PacketPool::Handle::operator * () const
+{
+    XY_ASSERT(m_entry, "Packet handle is empty");
+    return m_entry->packet;
+}
+
+sf::Packet* PacketPool::Handle::operator -> () const
+{
+    XY_ASSERT(m_entry, "Packet handle is empty");
+    return &m_entry->packet;
+}
+
+void PacketPool::Handle::reset()
+{
+    if (m_entry && m_entry->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        m_entry->pool->release(m_entry);
+    }
+    m_entry = nullptr;
+}
+
+//---------------------------------------------------------
+PacketPool::PacketPool(std::size_t reserve)
+{
+    for (auto i = 0u; i < reserve; ++i)
+    {
+        m_entries.emplace_back(std::make_unique<Entry>());
+        m_entries.back()->pool = this;
+        m_freeEntries.push_back(m_entries.back().get());
+    }
+}
+
+PacketPool::~PacketPool()
+{
+    XY_ASSERT(m_freeEntries.size() == m_entries.size(), "Packets still in use when pool destroyed");
+}
+
+//public
+PacketPool::Handle PacketPool::acquire()
+{
+    Entry* entry = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_freeEntries.empty())
+        {
+            m_entries.emplace_back(std::make_unique<Entry>());
+            entry = m_entries.back().get();
+            entry->pool = this;
+            //keeps the free list from reallocating when this is released
+            m_freeEntries.reserve(m_entries.size());
+        }
+        else
+        {
+            entry = m_freeEntries.back();
+            m_freeEntries.pop_back();
+        }
+    }
+
+    entry->refCount.store(1, std::memory_order_relaxed);
+    return Handle(entry);
+}
+
+std::size_t PacketPool::getPacketCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+//private
+void PacketPool::release(Entry* entry)
+{
+    if (entry->packet.getDataSize() > maxRetainedSize)
+    {
+        entry->packet = sf::Packet();
+    }
+    else
+    {
+        entry->packet.clear();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_freeEntries.push_back(entry);
+}
@@ -28,16 +28,14 @@ source distribution.
 -----------------------------------------------------------------------*/
 
 #include <components/PlayerDrawable.hpp>
+#include <AssetManager.hpp>
 
 #include <xygine/Entity.hpp>
-#include <xygine/util/Json.hpp>
 #include <xygine/util/Random.hpp>
 
 #include <SFML/Graphics/RenderStates.hpp>
 #include <SFML/Graphics/RenderTarget.hpp>
 
-#include <functional>
-
 namespace
 {
     const sf::Vector2f tileSize(16.f, 16.f);
@@ -61,7 +59,7 @@ namespace
     };
 }
 
-PlayerDrawable::PlayerDrawable(xy::MessageBus& mb, sf::Texture& texture, bool local)
+PlayerDrawable::PlayerDrawable(xy::MessageBus& mb, sf::Texture& texture, const TileSet& tileSet, bool local)
     : xy::Component (mb, this),
     m_direction     (Direction::Right),
     m_origins       (4),
@@ -70,7 +68,7 @@ PlayerDrawable::PlayerDrawable(xy::MessageBus& mb, sf::Texture& texture, bool lo
     m_texture       (texture),
     m_jiggleIndex   (0u)
 {
-    createSprites(local);
+    createSprites(tileSet, local);
     setDirection(Direction::Right);
 }
 
@@ -115,74 +113,25 @@ void PlayerDrawable::setDirection(Direction dir)
 }
 
 //private
-void PlayerDrawable::createSprites(bool local)
+void PlayerDrawable::createSprites(const TileSet& tileSet, bool local)
 {
-    std::ifstream file("assets/images/tileset.tst");
-    if (file.good() && xy::Util::File::validLength(file))
-    {
-        std::string jsonString;
-        std::string temp;
-        while (!file.eof())
-        {
-            file >> temp;
-            jsonString += temp;
-        }
-        if (!jsonString.empty())
-        {           
-            picojson::value rootValue;
-            auto err = picojson::parse(rootValue, jsonString);
-            if (err.empty())
-            {
-                std::function<sf::Vector2f(const std::string&, const picojson::value&)> getValue =
-                    [](const std::string& name, const picojson::value& source)
-                {
-                    if (source.get(name).is<picojson::array>())
-                    {
-                        auto arr = source.get(name).get<picojson::array>();
-                        sf::Vector2f pos
-                            (
-                                arr[0].is<double>() ? static_cast<float>(arr[0].get<double>()) : 0.f,
-                                arr[1].is<double>() ? static_cast<float>(arr[1].get<double>()) : 0.f
-                                );
-                        return pos;
-                    }
-                    return sf::Vector2f();
-                };
-
-                //up sprite
-                auto handle = getValue("handle_u", rootValue);
-                auto body = (local) ? getValue("player1_u", rootValue) : getValue("player2_u", rootValue);
-                buildSprite(handle, body, Direction::Up);
-
-                //down sprite
-                handle = getValue("handle_d", rootValue);
-                body = (local) ? getValue("player1_d", rootValue) : getValue("player2_d", rootValue);
-                buildSprite(handle, body, Direction::Down);
-
-                //right sprite
-                handle = getValue("handle_h", rootValue);
-                body = (local) ? getValue("player1_h", rootValue) : getValue("player2_h", rootValue);
-                buildSprite(handle, body, Direction::Right);
-
-                //left sprite - we can get this by flipping tex coords of right sprite :)
-                buildSprite(handle, body, Direction::Left);
-            }
-            else
-            {
-                xy::Logger::log("tileset data: " + err, xy::Logger::Type::Error, xy::Logger::Output::All);
-            }
-        }
-        else
-        {
-            xy::Logger::log("tileset data file is empty", xy::Logger::Type::Error, xy::Logger::Output::All);
-        }
-    }
-    else
-    {
-        //always write this, and write to log file so we can see this in release builds
-        xy::Logger::log("failed to open tileset data file.", xy::Logger::Type::Error, xy::Logger::Output::All);
-    }
-    file.close();
+    //up sprite
+    auto handle = tileSet.get("handle_u");
+    auto body = (local) ? tileSet.get("player1_u") : tileSet.get("player2_u");
+    buildSprite(handle, body, Direction::Up);
+
+    //down sprite
+    handle = tileSet.get("handle_d");
+    body = (local) ? tileSet.get("player1_d") : tileSet.get("player2_d");
+    buildSprite(handle, body, Direction::Down);
+
+    //right sprite
+    handle = tileSet.get("handle_h");
+    body = (local) ? tileSet.get("player1_h") : tileSet.get("player2_h");
+    buildSprite(handle, body, Direction::Right);
+
+    //left sprite - we can get this by flipping tex coords of right sprite :)
+    buildSprite(handle, body, Direction::Left);
 }
 
 void PlayerDrawable::buildSprite(const sf::Vector2f& handle, const sf::Vector2f& body, Direction dir)
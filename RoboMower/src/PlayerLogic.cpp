@@ -30,15 +30,18 @@ source distribution.
 #include <components/PlayerLogic.hpp>
 #include <components/PlayerDrawable.hpp>
 #include <Messages.hpp>
-#include <InstructionSet.hpp>
+#include <Hash.hpp>
 
 #include <xygine/Entity.hpp>
 #include <xygine/components/ParticleSystem.hpp>
 #include <xygine/util/Vector.hpp>
 #include <xygine/Reports.hpp>
 
-#include <array>
-#include <map>
+#include <SFML/Network/Packet.hpp>
+#include <SFML/System/Clock.hpp>
+
+#include <cmath>
+#include <limits>
 
 namespace
 {
@@ -48,7 +51,12 @@ namespace
     const sf::Vector2f tileSize(64.f, 64.f);
     const float rotationTime = 0.5f;
 
-    std::map<Instruction, std::function<bool(xy::Entity&, float)>> instructions;
+    //the simulation always runs at this rate regardless of frame rate
+    const float timeStep = 1.f / 60.f;
+    //prevents spiralling if the app stalls for a long time
+    const sf::Uint32 maxStepsPerUpdate = 30;
+    //the clock is only checked every so often when running flat out
+    const sf::Uint32 stepsPerBudgetCheck = 32;
 }
 
 PlayerLogic::PlayerLogic(xy::MessageBus& mb, const sf::Vector2f& spawnPosition)
@@ -57,65 +65,79 @@ PlayerLogic::PlayerLogic(xy::MessageBus& mb, const sf::Vector2f& spawnPosition)
     m_spawnPosition     (spawnPosition),
     m_clientID          (-1),
     m_currentDirection  (Direction::Right),
+    m_rotationTime      (0.f),
     m_transportStatus   (TransportStatus::Stopped),
     m_programCounter    (0),
     m_loopDestination   (0),
     m_loopCounter       (0),
-    m_currentParameter  (0)
+    m_currentParameter  (0),
+    m_currentInstruction(Instruction::NOP),
+    m_tick              (0),
+    m_accumulator       (0.f),
+    m_speed             (TransportSpeed::Normal),
+    m_stepBudget        (sf::milliseconds(4)),
+    m_desynchronised    (false)
 {
-    instructions.insert(std::make_pair(Instruction::NOP, 
+    clearHistory();
+
+    m_instructions.insert(std::make_pair(Instruction::NOP, 
         [this](xy::Entity&, float)
     {return true; }));
     
-    instructions.insert(std::make_pair(Instruction::EngineOn,
+    m_instructions.insert(std::make_pair(Instruction::EngineOn,
         [this](xy::Entity& entity, float dt)
     {
         return true;
     }));
 
-    instructions.insert(std::make_pair(Instruction::EngineOff,
+    m_instructions.insert(std::make_pair(Instruction::EngineOff,
         [this](xy::Entity& entity, float dt)
     {
         return true;
     }));
 
-    instructions.insert(std::make_pair(Instruction::Forward,
+    m_instructions.insert(std::make_pair(Instruction::Forward,
         [this](xy::Entity& entity, float dt)
     {
         auto path = m_target - entity.getPosition();
-        if (xy::Util::Vector::lengthSquared(path) > 2)
+        auto distance = std::sqrt(xy::Util::Vector::lengthSquared(path));
+        //snap to the target so mowers always end on a tile
+        if (distance <= movespeed * dt)
         {
-            entity.move(xy::Util::Vector::normalise(path) * movespeed * dt);
-            return false;
+            entity.setPosition(m_target);
+            return true;
         }
-        return true;
+        entity.move((path / distance) * movespeed * dt);
+        return false;
     }));
 
-    instructions.insert(std::make_pair(Instruction::Right,
+    m_instructions.insert(std::make_pair(Instruction::Right,
         [this](xy::Entity& entity, float dt)
     {
-        if (m_rotationTimer.getElapsedTime().asSeconds() > rotationTime)
+        m_rotationTime += dt;
+        if (m_rotationTime > rotationTime)
         {
-            m_rotationTimer.restart();
+            m_rotationTime = 0.f;
             m_currentDirection = static_cast<Direction>((static_cast<sf::Uint8>(m_currentDirection) + 1) % static_cast<sf::Uint8>(Direction::Count));
             m_currentParameter--;           
         }
         return (m_currentParameter == 0);
     }));
 
-    instructions.insert(std::make_pair(Instruction::Left,
+    m_instructions.insert(std::make_pair(Instruction::Left,
         [this](xy::Entity& entity, float dt)
     {
-        if (m_rotationTimer.getElapsedTime().asSeconds() > rotationTime)
+        m_rotationTime += dt;
+        if (m_rotationTime > rotationTime)
         {
-            m_rotationTimer.restart();
+            m_rotationTime = 0.f;
             m_currentDirection = static_cast<Direction>((static_cast<sf::Uint8>(m_currentDirection) + static_cast<sf::Uint8>(Direction::Count) - 1) % static_cast<sf::Uint8>(Direction::Count));
             m_currentParameter--;
         }
         return (m_currentParameter == 0);
     }));
 
-    instructions.insert(std::make_pair(Instruction::Loop,
+    m_instructions.insert(std::make_pair(Instruction::Loop,
         [this](xy::Entity& entity, float dt)
     { 
         REPORT("Loop count", std::to_string(m_loopCounter));
@@ -128,82 +150,44 @@ PlayerLogic::PlayerLogic(xy::MessageBus& mb, const sf::Vector2f& spawnPosition)
         return true;
     }));
 
-    m_currentAction = instructions[Instruction::NOP];
+    m_currentAction = m_instructions[Instruction::NOP];
 }
 
 //public
 void PlayerLogic::entityUpdate(xy::Entity& entity, float dt)
 {
-    if (m_transportStatus == TransportStatus::Playing)
-    {       
-        REPORT("Current Parameter", std::to_string(m_currentParameter));
-        Direction direction = m_currentDirection;
-        if(m_currentAction(entity, dt))
+    if (m_transportStatus != TransportStatus::Playing)
+    {
+        m_accumulator = 0.f;
+        return;
+    }
+
+    if (m_speed == TransportSpeed::Max)
+    {
+        m_accumulator = 0.f;
+        sf::Clock clock;
+        sf::Uint32 steps = 0;
+        while (m_transportStatus == TransportStatus::Playing)
         {
-            //quit if we finished
-            if (m_programCounter == m_program.size())
-            {
-                stop();
-                //LOG("Finished running program", xy::Logger::Type::Info);
-                return;
-            }            
-            
-            //action completed get next instruction and its parameter
-            Instruction instruction = static_cast<Instruction>(m_program[m_programCounter++]);
-            m_currentParameter = m_program[m_programCounter++];
-            
-            REPORT("Current Instruction", std::to_string(sf::Uint8(instruction)));
-            
-            //set up inital action values
-            switch (instruction)
-            {
-            default: break;
-            case Instruction::EngineOn: break;
-            case Instruction::EngineOff: break;
-            case Instruction::Forward:
+            step(entity);
+            if (++steps % stepsPerBudgetCheck == 0
+                && clock.getElapsedTime() >= m_stepBudget)
             {
-                //calc the target from the current direction and entity position
-                m_target = entity.getPosition();
-                switch (m_currentDirection)
-                {
-                default: break;
-                case Direction::Left:
-                    m_target.x -= tileSize.x * static_cast<float>(m_currentParameter);
-                    break;
-                case Direction::Right:
-                    m_target.x += tileSize.x * static_cast<float>(m_currentParameter);
-                    break;
-                case Direction::Up:
-                    m_target.y -= tileSize.y * static_cast<float>(m_currentParameter);
-                    break;
-                case Direction::Down:
-                    m_target.y += tileSize.y * static_cast<float>(m_currentParameter);
-                    break;
-                }
-            }
-                break;
-            case Instruction::Right:
-            case Instruction::Left:
-                m_rotationTimer.restart();
-                break;
-            case Instruction::Loop:
-                m_loopDestination = m_program[m_programCounter++];
-                if(m_loopCounter == 0) m_loopCounter = m_currentParameter;
                 break;
             }
-            //update the current action
-            m_currentAction = instructions[instruction];
-
-            REPORT("Program Counter", std::to_string(m_programCounter));
         }
+        return;
+    }
 
-        //check if action changed our direction and message if so
-        if (direction != m_currentDirection)
-        {
-            auto msg = sendMessage<DirectionEvent>(DirectionMessage);
-            msg->id = m_clientID;
-            msg->direction = m_currentDirection;
-        }
+    auto multiplier = getSpeedMultiplier(m_speed);
+    m_accumulator += dt * multiplier;
+    sf::Uint32 steps = 0;
+    while (m_accumulator >= timeStep
+        && m_transportStatus == TransportStatus::Playing
+        && steps++ < maxStepsPerUpdate * multiplier)
+    {
+        step(entity);
+        m_accumulator -= timeStep;
     }
 }
 
@@ -235,6 +219,8 @@ void PlayerLogic::rewind()
         stop();
         m_entity->setPosition(m_spawnPosition);
         m_currentDirection = Direction::Right;
+        m_tick = 0;
+        clearHistory();
 
         auto msg = sendMessage<DirectionEvent>(DirectionMessage);
         msg->id = m_clientID;
@@ -242,14 +228,245 @@ void PlayerLogic::rewind()
     }
 }
 
+void PlayerLogic::reset(const sf::Vector2f& spawnPosition)
+{
+    m_spawnPosition = spawnPosition;
+    if (m_entity) m_entity->setPosition(spawnPosition);
+
+    m_clientID = -1;
+    m_currentDirection = Direction::Right;
+    m_target = {};
+    m_rotationTime = 0.f;
+    m_transportStatus = TransportStatus::Stopped;
+    m_program.clear();
+    m_programCounter = 0;
+    m_loopDestination = 0;
+    m_loopCounter = 0;
+    m_currentParameter = 0;
+    m_currentInstruction = Instruction::NOP;
+    m_currentAction = m_instructions[Instruction::NOP];
+    m_tick = 0;
+    m_accumulator = 0.f;
+    m_speed = TransportSpeed::Normal;
+    clearHistory();
+}
+
+void PlayerLogic::advanceTo(sf::Uint32 tick)
+{
+    if (!m_entity) return;
+
+    while (m_tick < tick && m_transportStatus == TransportStatus::Playing)
+    {
+        step(*m_entity);
+    }
+}
+
+PlayerLogic::State PlayerLogic::getState() const
+{
+    State state;
+    state.tick = m_tick;
+    state.position = m_entity ? m_entity->getPosition() : m_spawnPosition;
+    state.target = m_target;
+    state.direction = m_currentDirection;
+    state.transportStatus = m_transportStatus;
+    state.programCounter = static_cast<sf::Uint16>(m_programCounter);
+    state.loopDestination = static_cast<sf::Uint16>(m_loopDestination);
+    state.loopCounter = m_loopCounter;
+    state.currentParameter = m_currentParameter;
+    state.currentInstruction = static_cast<sf::Uint8>(m_currentInstruction);
+    state.rotationTime = m_rotationTime;
+    return state;
+}
+
+void PlayerLogic::setState(const State& state)
+{
+    auto oldDirection = m_currentDirection;
+
+    m_tick = state.tick;
+    if (m_entity) m_entity->setPosition(state.position);
+    m_target = state.target;
+    m_currentDirection = state.direction;
+    m_transportStatus = state.transportStatus;
+    m_programCounter = state.programCounter;
+    m_loopDestination = state.loopDestination;
+    m_loopCounter = state.loopCounter;
+    m_currentParameter = state.currentParameter;
+    m_currentInstruction = static_cast<Instruction>(state.currentInstruction);
+    m_currentAction = m_instructions[m_currentInstruction];
+    m_rotationTime = state.rotationTime;
+    m_accumulator = 0.f;
+    clearHistory();
+
+    if (oldDirection != m_currentDirection)
+    {
+        auto msg = sendMessage<DirectionEvent>(DirectionMessage);
+        msg->id = m_clientID;
+        msg->direction = m_currentDirection;
+    }
+}
+
+sf::Uint32 PlayerLogic::getStateHash() const
+{
+    //positions are hashed at a fixed precision so tiny float
+    //differences between platforms don't cause false alarms
+    auto position = m_entity ? m_entity->getPosition() : m_spawnPosition;
+    sf::Int32 x = static_cast<sf::Int32>(std::round(position.x * 8.f));
+    sf::Int32 y = static_cast<sf::Int32>(std::round(position.y * 8.f));
+
+    auto hash = Hash::combine(Hash::Seed, m_tick);
+    hash = Hash::combine(hash, x);
+    hash = Hash::combine(hash, y);
+    hash = Hash::combine(hash, m_currentDirection);
+    hash = Hash::combine(hash, static_cast<sf::Uint32>(m_programCounter));
+    return hash;
+}
+
+PlayerLogic::Checkpoint PlayerLogic::verify(sf::Uint32 tick, sf::Uint32 hash)
+{
+    if (tick > m_tick)
+    {
+        m_pendingCheckpoints.emplace_back(tick, hash);
+        return Checkpoint::Pending;
+    }
+
+    const auto& entry = (tick == m_tick) ?
+        std::make_pair(m_tick, getStateHash()) : m_hashHistory[tick % m_hashHistory.size()];
+
+    if (entry.first != tick) return Checkpoint::Expired;
+    if (entry.second != hash)
+    {
+        m_desynchronised = true;
+        return Checkpoint::Mismatch;
+    }
+    return Checkpoint::Match;
+}
+
 //private
+void PlayerLogic::step(xy::Entity& entity)
+{
+    REPORT("Current Parameter", std::to_string(m_currentParameter));
+    Direction direction = m_currentDirection;
+    if (m_currentAction(entity, timeStep))
+    {
+        //quit if we finished
+        if (m_programCounter >= m_program.size())
+        {
+            stop();
+            //LOG("Finished running program", xy::Logger::Type::Info);
+            return;
+        }
+
+        //action completed get next instruction and its parameter
+        m_currentInstruction = static_cast<Instruction>(m_program[m_programCounter++]);
+        m_currentParameter = m_program[m_programCounter++];
+
+        REPORT("Current Instruction", std::to_string(sf::Uint8(m_currentInstruction)));
+
+        //set up inital action values
+        switch (m_currentInstruction)
+        {
+        default: break;
+        case Instruction::EngineOn: break;
+        case Instruction::EngineOff: break;
+        case Instruction::Forward:
+        {
+            //calc the target from the current direction and entity position
+            m_target = entity.getPosition();
+            switch (m_currentDirection)
+            {
+            default: break;
+            case Direction::Left:
+                m_target.x -= tileSize.x * static_cast<float>(m_currentParameter);
+                break;
+            case Direction::Right:
+                m_target.x += tileSize.x * static_cast<float>(m_currentParameter);
+                break;
+            case Direction::Up:
+                m_target.y -= tileSize.y * static_cast<float>(m_currentParameter);
+                break;
+            case Direction::Down:
+                m_target.y += tileSize.y * static_cast<float>(m_currentParameter);
+                break;
+            }
+        }
+            break;
+        case Instruction::Right:
+        case Instruction::Left:
+            m_rotationTime = 0.f;
+            break;
+        case Instruction::Loop:
+            m_loopDestination = m_program[m_programCounter++];
+            if (m_loopCounter == 0) m_loopCounter = m_currentParameter;
+            break;
+        }
+        //update the current action
+        m_currentAction = m_instructions[m_currentInstruction];
+
+        REPORT("Program Counter", std::to_string(m_programCounter));
+    }
+    m_tick++;
+
+    //record the result of this tick so late checkpoints can be compared
+    auto hash = getStateHash();
+    m_hashHistory[m_tick % m_hashHistory.size()] = std::make_pair(m_tick, hash);
+    for (auto i = 0u; i < m_pendingCheckpoints.size();)
+    {
+        if (m_pendingCheckpoints[i].first == m_tick)
+        {
+            if (m_pendingCheckpoints[i].second != hash) m_desynchronised = true;
+            m_pendingCheckpoints.erase(m_pendingCheckpoints.begin() + i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    //check if action changed our direction and message if so
+    if (direction != m_currentDirection)
+    {
+        auto msg = sendMessage<DirectionEvent>(DirectionMessage);
+        msg->id = m_clientID;
+        msg->direction = m_currentDirection;
+    }
+}
+
+void PlayerLogic::clearHistory()
+{
+    m_hashHistory.fill(std::make_pair(std::numeric_limits<sf::Uint32>::max(), 0u));
+    m_pendingCheckpoints.clear();
+    m_desynchronised = false;
+}
+
 void PlayerLogic::stop()
 {
     m_transportStatus = TransportStatus::Stopped;
     m_programCounter = 0;
-    m_currentAction = instructions[Instruction::NOP];
+    m_currentInstruction = Instruction::NOP;
+    m_currentAction = m_instructions[Instruction::NOP];
 
     auto msg = sendMessage<PlayerEvent>(PlayerMessage);
     msg->action = PlayerEvent::FinishedProgram;
     msg->id = m_clientID;
+}
+
+//---------------------------------------------------------
+sf::Packet& operator << (sf::Packet& p, const PlayerLogic::State& state)
+{
+    p << state.tick << state.position.x << state.position.y;
+    p << state.target.x << state.target.y;
+    p << state.direction << state.transportStatus;
+    p << state.programCounter << state.loopDestination << state.loopCounter;
+    p << state.currentParameter << state.currentInstruction << state.rotationTime;
+    return p;
+}
+
+sf::Packet& operator >> (sf::Packet& p, PlayerLogic::State& state)
+{
+    p >> state.tick >> state.position.x >> state.position.y;
+    p >> state.target.x >> state.target.y;
+    p >> state.direction >> state.transportStatus;
+    p >> state.programCounter >> state.loopDestination >> state.loopCounter;
+    p >> state.currentParameter >> state.currentInstruction >> state.rotationTime;
+    return p;
 }
\ No newline at end of file
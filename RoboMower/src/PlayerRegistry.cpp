@@ -0,0 +1,133 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+#include <PlayerRegistry.hpp>
+
+#include <xygine/Assert.hpp>
+
+//public
+PlayerHandle PlayerRegistry::add(const Player& player)
+{
+    if (m_clientLookup.count(player.id)) return {};
+
+    sf::Uint16 slotIndex = 0;
+    if (!m_freeSlots.empty())
+    {
+        //reuse freed slots first to keep slot indices compact
+        slotIndex = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+    else
+    {
+        XY_ASSERT(m_slots.size() < PlayerHandle::InvalidIndex, "Player registry is full");
+        slotIndex = static_cast<sf::Uint16>(m_slots.size());
+        m_slots.emplace_back();
+    }
+
+    auto& slot = m_slots[slotIndex];
+    slot.denseIndex = static_cast<sf::Uint16>(m_players.size());
+
+    PlayerHandle handle;
+    handle.index = slotIndex;
+    handle.generation = slot.generation;
+
+    m_players.push_back(player);
+    m_players.back().handle = handle;
+    m_clientLookup[player.id] = handle;
+
+    return handle;
+}
+
+bool PlayerRegistry::remove(PlayerHandle handle)
+{
+    if (!get(handle)) return false;
+
+    auto& slot = m_slots[handle.index];
+    auto denseIndex = slot.denseIndex;
+    m_clientLookup.erase(m_players[denseIndex].id);
+
+    //swap the last player into the hole and patch its slot
+    if (denseIndex != m_players.size() - 1)
+    {
+        m_players[denseIndex] = std::move(m_players.back());
+        m_slots[m_players[denseIndex].handle.index].denseIndex = denseIndex;
+    }
+    m_players.pop_back();
+
+    //bumping the generation invalidates any outstanding handles
+    slot.denseIndex = PlayerHandle::InvalidIndex;
+    slot.generation++;
+    m_freeSlots.push_back(handle.index);
+
+    return true;
+}
+
+bool PlayerRegistry::remove(xy::ClientID id)
+{
+    return remove(getHandle(id));
+}
+
+void PlayerRegistry::clear()
+{
+    for (auto i = 0u; i < m_slots.size(); ++i)
+    {
+        if (m_slots[i].denseIndex != PlayerHandle::InvalidIndex)
+        {
+            m_slots[i].denseIndex = PlayerHandle::InvalidIndex;
+            m_slots[i].generation++;
+            m_freeSlots.push_back(static_cast<sf::Uint16>(i));
+        }
+    }
+    m_players.clear();
+    m_clientLookup.clear();
+}
+
+PlayerRegistry::Player* PlayerRegistry::get(PlayerHandle handle)
+{
+    if (!handle.valid() || handle.index >= m_slots.size()) return nullptr;
+
+    const auto& slot = m_slots[handle.index];
+    if (slot.generation != handle.generation
+        || slot.denseIndex == PlayerHandle::InvalidIndex)
+    {
+        return nullptr;
+    }
+    return &m_players[slot.denseIndex];
+}
+
+PlayerRegistry::Player* PlayerRegistry::find(xy::ClientID id)
+{
+    return get(getHandle(id));
+}
+
+PlayerHandle PlayerRegistry::getHandle(xy::ClientID id) const
+{
+    auto result = m_clientLookup.find(id);
+    return (result == m_clientLookup.end()) ? PlayerHandle() : result->second;
+}
@@ -0,0 +1,100 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+#include <ProgramStore.hpp>
+#include <Hash.hpp>
+
+#include <xygine/Assert.hpp>
+
+#include <algorithm>
+
+//public
+ProgramStore::Digest ProgramStore::digest(const Program& program)
+{
+    //the store is shared by every client, so this must be hard to collide
+    //on purpose. The first 64 bits of SHA-256 are still far out of reach
+    auto hash = Hash::sha256(program.data(), program.size());
+    Digest digest = 0;
+    for (auto i = 0u; i < sizeof(Digest); ++i)
+    {
+        digest = (digest << 8) | hash[i];
+    }
+    return digest;
+}
+
+ProgramStore::ProgramStore(std::size_t capacity)
+    : m_capacity    (capacity),
+    m_useCount      (0)
+{
+    XY_ASSERT(capacity > 0, "Program store needs a capacity");
+}
+
+const ProgramStore::Program* ProgramStore::find(Digest digest)
+{
+    auto result = m_programs.find(digest);
+    if (result == m_programs.end()) return nullptr;
+
+    result->second.lastUsed = ++m_useCount;
+    return &result->second.program;
+}
+
+bool ProgramStore::insert(Digest digest, const Program& program)
+{
+    if (ProgramStore::digest(program) != digest) return false;
+
+    auto existing = m_programs.find(digest);
+    if (existing != m_programs.end())
+    {
+        //never replace a program someone else may be relying on
+        if (existing->second.program != program) return false;
+
+        existing->second.lastUsed = ++m_useCount;
+        return true;
+    }
+
+    if (m_programs.size() >= m_capacity)
+    {
+        auto oldest = std::min_element(m_programs.begin(), m_programs.end(),
+            [](const std::pair<const Digest, Entry>& a, const std::pair<const Digest, Entry>& b)
+        {
+            return a.second.lastUsed < b.second.lastUsed;
+        });
+        m_programs.erase(oldest);
+    }
+
+    auto& entry = m_programs[digest];
+    entry.program = program;
+    entry.lastUsed = ++m_useCount;
+    return true;
+}
+
+void ProgramStore::clear()
+{
+    m_programs.clear();
+}
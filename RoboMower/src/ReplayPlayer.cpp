@@ -0,0 +1,246 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+#include <ReplayPlayer.hpp>
+#include <PacketEnums.hpp>
+#include <components/PlayerLogic.hpp>
+
+#include <xygine/Entity.hpp>
+#include <xygine/Log.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+    template <typename T>
+    T readLE(const sf::Uint8* data)
+    {
+        sf::Uint64 value = 0;
+        for (auto i = 0u; i < sizeof(T); ++i)
+        {
+            value |= static_cast<sf::Uint64>(data[i]) << (i * 8);
+        }
+        return static_cast<T>(value);
+    }
+}
+
+ReplayPlayer::ReplayPlayer()
+    : m_scene   (m_messageBus),
+    m_nextEvent (0),
+    m_mapSeed   (0),
+    m_speed     (1.f),
+    m_time      (0.f)
+{
+
+}
+
+//public
+bool ReplayPlayer::load(const std::string& path)
+{
+    m_events.clear();
+    m_nextEvent = 0;
+    m_time = 0.f;
+    m_summary = {};
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.good())
+    {
+        LOG("Failed opening replay " + path, xy::Logger::Type::Error);
+        return false;
+    }
+    std::vector<sf::Uint8> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    if (data.size() < Replay::HeaderSize
+        || !std::equal(std::begin(Replay::Magic), std::end(Replay::Magic), data.begin())
+        || readLE<sf::Uint16>(&data[4]) != Replay::Version)
+    {
+        LOG(path + ": not a replay file or unsupported version", xy::Logger::Type::Error);
+        return false;
+    }
+    m_mapSeed = readLE<sf::Uint32>(&data[6]);
+
+    //a session which didn't shut down cleanly may end with a partial event
+    auto position = Replay::HeaderSize;
+    while (data.size() - position >= Replay::EventHeaderSize)
+    {
+        const auto* header = &data[position];
+        auto payloadSize = readLE<sf::Uint16>(header + 13);
+        if (data.size() - position - Replay::EventHeaderSize < payloadSize) break;
+
+        Replay::Event evt;
+        evt.type = static_cast<Replay::EventType>(header[0]);
+        evt.time = readLE<sf::Uint32>(header + 1);
+        evt.clientID = readLE<xy::ClientID>(header + 5);
+        evt.tick = readLE<sf::Uint32>(header + 9);
+
+        const auto* payload = header + Replay::EventHeaderSize;
+        evt.payload.assign(payload, payload + payloadSize);
+        m_events.push_back(std::move(evt));
+
+        position += Replay::EventHeaderSize + payloadSize;
+    }
+
+    if (position != data.size())
+    {
+        LOG(path + ": replay is truncated", xy::Logger::Type::Warning);
+    }
+
+    m_summary.duration = m_events.empty() ? 0 : m_events.back().time;
+    LOG("Loaded " + std::to_string(m_events.size()) + " events from " + path, xy::Logger::Type::Info);
+    return true;
+}
+
+void ReplayPlayer::update(float dt)
+{
+    dt *= m_speed;
+    m_time += dt;
+    auto timeMs = static_cast<sf::Uint32>(m_time * 1000.f);
+
+    while (m_nextEvent < m_events.size() && m_events[m_nextEvent].time <= timeMs)
+    {
+        apply(m_events[m_nextEvent++]);
+    }
+
+    m_scene.update(dt);
+    flushMessages();
+}
+
+void ReplayPlayer::runToEnd()
+{
+    //the simulations only advance when an event says where they should be
+    while (m_nextEvent < m_events.size())
+    {
+        apply(m_events[m_nextEvent++]);
+    }
+    m_time = m_summary.duration / 1000.f;
+}
+
+//private
+void ReplayPlayer::apply(const Replay::Event& evt)
+{
+    m_summary.events++;
+
+    switch (evt.type)
+    {
+    default: break;
+    case Replay::EventType::PlayerJoined:
+    {
+        if (evt.payload.size() < 8 || m_players.count(evt.clientID)) break;
+
+        sf::Vector2f spawnPosition(Replay::bitsFloat(readLE<sf::Uint32>(&evt.payload[0])),
+            Replay::bitsFloat(readLE<sf::Uint32>(&evt.payload[4])));
+
+        auto pl = xy::Component::create<PlayerLogic>(m_messageBus, spawnPosition);
+        pl->setClientID(evt.clientID);
+
+        auto entity = xy::Entity::create(m_messageBus);
+        entity->addComponent(pl);
+        m_players[evt.clientID] = m_scene.addEntity(entity, xy::Scene::Layer::BackFront);
+
+        //logic components are only attached to their entity once the scene updates
+        m_scene.update(0.f);
+    }
+        break;
+    case Replay::EventType::PlayerLeft:
+    {
+        auto result = m_players.find(evt.clientID);
+        if (result != m_players.end())
+        {
+            result->second->destroy();
+            m_players.erase(result);
+        }
+    }
+        break;
+    case Replay::EventType::Program:
+        if (auto logic = getPlayerLogic(evt.clientID))
+        {
+            logic->setProgram(evt.payload);
+        }
+        break;
+    case Replay::EventType::Transport:
+    {
+        auto logic = getPlayerLogic(evt.clientID);
+        if (!logic || evt.payload.empty()) break;
+
+        switch (static_cast<TransportChange>(evt.payload[0]))
+        {
+        default: break;
+        case TransportChange::Play:
+            logic->start();
+            logic->advanceTo(evt.tick);
+            break;
+        case TransportChange::Pause:
+            logic->advanceTo(evt.tick);
+            logic->pause();
+            break;
+        case TransportChange::Rewind:
+            logic->pause();
+            logic->rewind();
+            break;
+        }
+    }
+        break;
+    case Replay::EventType::StateHash:
+    {
+        auto logic = getPlayerLogic(evt.clientID);
+        if (!logic || evt.payload.size() < 4) break;
+
+        logic->advanceTo(evt.tick);
+        auto result = logic->verify(evt.tick, readLE<sf::Uint32>(&evt.payload[0]));
+        if (result == PlayerLogic::Checkpoint::Match)
+        {
+            m_summary.checkpoints++;
+        }
+        else if (result == PlayerLogic::Checkpoint::Mismatch)
+        {
+            m_summary.checkpoints++;
+            m_summary.mismatches++;
+            LOG("Replay: player " + std::to_string(evt.clientID) + " diverged at tick " + std::to_string(evt.tick), xy::Logger::Type::Warning);
+        }
+    }
+        break;
+    }
+    flushMessages();
+}
+
+void ReplayPlayer::flushMessages()
+{
+    while (!m_messageBus.empty())
+    {
+        m_scene.handleMessage(m_messageBus.poll());
+    }
+}
+
+PlayerLogic* ReplayPlayer::getPlayerLogic(xy::ClientID id)
+{
+    auto result = m_players.find(id);
+    return (result == m_players.end()) ? nullptr : result->second->getComponent<PlayerLogic>();
+}
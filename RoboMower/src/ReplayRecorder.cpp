@@ -0,0 +1,172 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+#include <ReplayRecorder.hpp>
+
+#include <xygine/Log.hpp>
+#include <xygine/Assert.hpp>
+
+namespace
+{
+    //the writer wakes this often even if nothing asks it to, so a
+    //crash loses at most this much of the session
+    const std::chrono::milliseconds flushInterval(500);
+
+    template <typename T>
+    void writeLE(std::vector<sf::Uint8>& dest, T value)
+    {
+        for (auto i = 0u; i < sizeof(T); ++i)
+        {
+            dest.push_back(static_cast<sf::Uint8>((static_cast<sf::Uint64>(value) >> (i * 8)) & 0xff));
+        }
+    }
+}
+
+ReplayRecorder::ReplayRecorder()
+    : m_running(false)
+{
+
+}
+
+ReplayRecorder::~ReplayRecorder()
+{
+    close();
+}
+
+//public
+bool ReplayRecorder::open(const std::string& path, sf::Uint32 mapSeed)
+{
+    close();
+
+    m_file.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_file.good())
+    {
+        LOG("Failed opening " + path + " for recording", xy::Logger::Type::Error);
+        return false;
+    }
+
+    std::vector<sf::Uint8> header(std::begin(Replay::Magic), std::end(Replay::Magic));
+    writeLE(header, Replay::Version);
+    writeLE(header, mapSeed);
+    XY_ASSERT(header.size() == Replay::HeaderSize, "Incorrect replay header size");
+    m_file.write(reinterpret_cast<const char*>(header.data()), header.size());
+
+    m_buffer.clear();
+    m_clock.restart();
+    m_running = true;
+    m_thread = std::thread(&ReplayRecorder::threadFunc, this);
+
+    LOG("Recording session to " + path, xy::Logger::Type::Info);
+    return true;
+}
+
+void ReplayRecorder::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) return;
+        m_running = false;
+    }
+    m_condition.notify_one();
+    m_thread.join();
+    m_file.close();
+}
+
+void ReplayRecorder::playerJoined(xy::ClientID id, const std::string& name, const sf::Vector2f& spawnPosition)
+{
+    std::vector<sf::Uint8> payload;
+    writeLE(payload, Replay::floatBits(spawnPosition.x));
+    writeLE(payload, Replay::floatBits(spawnPosition.y));
+    payload.insert(payload.end(), name.begin(), name.end());
+    append(Replay::EventType::PlayerJoined, id, 0, payload.data(), payload.size());
+}
+
+void ReplayRecorder::playerLeft(xy::ClientID id)
+{
+    append(Replay::EventType::PlayerLeft, id, 0, nullptr, 0);
+}
+
+void ReplayRecorder::program(xy::ClientID id, sf::Uint32 tick, const std::vector<sf::Uint8>& program)
+{
+    append(Replay::EventType::Program, id, tick, program.data(), program.size());
+}
+
+void ReplayRecorder::transport(xy::ClientID id, sf::Uint32 tick, TransportChange change)
+{
+    auto value = static_cast<sf::Uint8>(change);
+    append(Replay::EventType::Transport, id, tick, &value, 1);
+}
+
+void ReplayRecorder::stateHash(xy::ClientID id, sf::Uint32 tick, sf::Uint32 hash)
+{
+    std::vector<sf::Uint8> payload;
+    writeLE(payload, hash);
+    append(Replay::EventType::StateHash, id, tick, payload.data(), payload.size());
+}
+
+//private
+void ReplayRecorder::append(Replay::EventType type, xy::ClientID id, sf::Uint32 tick, const void* payload, std::size_t size)
+{
+    XY_ASSERT(size <= 0xffff, "Replay event payload too large");
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_running) return;
+
+    writeLE(m_buffer, static_cast<sf::Uint8>(type));
+    writeLE(m_buffer, static_cast<sf::Uint32>(m_clock.getElapsedTime().asMilliseconds()));
+    writeLE(m_buffer, id);
+    writeLE(m_buffer, tick);
+    writeLE(m_buffer, static_cast<sf::Uint16>(size));
+    if (size > 0)
+    {
+        const auto* bytes = static_cast<const sf::Uint8*>(payload);
+        m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+    }
+}
+
+void ReplayRecorder::threadFunc()
+{
+    bool running = true;
+    while (running)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait_for(lock, flushInterval, [this]() { return !m_running; });
+            running = m_running;
+            m_writeBuffer.swap(m_buffer);
+        }
+
+        if (!m_writeBuffer.empty())
+        {
+            m_file.write(reinterpret_cast<const char*>(m_writeBuffer.data()), m_writeBuffer.size());
+            m_file.flush();
+            m_writeBuffer.clear();
+        }
+    }
+}
@@ -0,0 +1,285 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+#include <Snapshot.hpp>
+#include <NetProtocol.hpp>
+
+#include <xygine/Assert.hpp>
+
+#include <SFML/Network/Packet.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    enum FieldFlags
+    {
+        PositionX = 0x1,
+        PositionY = 0x2,
+        Heading = 0x4,
+        All = PositionX | PositionY | Heading
+    };
+    const sf::Uint8 fieldBits = 3;
+
+    //positions are relative to the lawn, which is 20x14 tiles of 64px.
+    //the range is generous enough for mowers which drive off the edge
+    const float positionMin = -2048.f;
+    const float positionMax = 4096.f;
+    const float positionPrecision = 0.125f;
+
+    //offset from the current sequence to the baseline. 0 means keyframe
+    const sf::Uint8 baselineBits = Bits::required(SnapshotHistory::Size - 1);
+    const sf::Uint8 slotSizeBits = 5;
+    const sf::Uint8 directionBits = 2;
+
+    bool entryLess(const Snapshot::Entry& a, const Snapshot::Entry& b)
+    {
+        return a.slot < b.slot;
+    }
+
+    float quantise(float value)
+    {
+        value = std::max(positionMin, std::min(positionMax, value));
+        return positionMin + std::round((value - positionMin) / positionPrecision) * positionPrecision;
+    }
+}
+
+//---------------------------------------------------------
+void Snapshot::add(const Entry& entry)
+{
+    auto result = std::lower_bound(entries.begin(), entries.end(), entry, entryLess);
+    if (result != entries.end() && result->slot == entry.slot)
+    {
+        *result = entry;
+    }
+    else
+    {
+        entries.insert(result, entry);
+    }
+}
+
+const Snapshot::Entry* Snapshot::find(sf::Uint16 slot) const
+{
+    Entry e;
+    e.slot = slot;
+    auto result = std::lower_bound(entries.begin(), entries.end(), e, entryLess);
+    return (result != entries.end() && result->slot == slot) ? &(*result) : nullptr;
+}
+
+bool Snapshot::operator == (const Snapshot& other) const
+{
+    if (entries.size() != other.entries.size()) return false;
+    for (auto i = 0u; i < entries.size(); ++i)
+    {
+        if (entries[i].slot != other.entries[i].slot
+            || entries[i].position != other.entries[i].position
+            || entries[i].direction != other.entries[i].direction)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//---------------------------------------------------------
+SnapshotHistory::SnapshotHistory()
+{
+    m_valid.fill(false);
+}
+
+void SnapshotHistory::insert(const Snapshot& snapshot)
+{
+    auto idx = snapshot.sequence % Size;
+    //assigning rather than replacing lets the slot reuse its storage
+    m_snapshots[idx].sequence = snapshot.sequence;
+    m_snapshots[idx].entries.assign(snapshot.entries.begin(), snapshot.entries.end());
+    m_valid[idx] = true;
+}
+
+const Snapshot* SnapshotHistory::get(xy::Network::SeqID sequence) const
+{
+    auto idx = sequence % Size;
+    return (m_valid[idx] && m_snapshots[idx].sequence == sequence) ? &m_snapshots[idx] : nullptr;
+}
+
+void SnapshotHistory::clear()
+{
+    m_valid.fill(false);
+}
+
+//---------------------------------------------------------
+void SnapshotCodec::quantise(Snapshot& snapshot)
+{
+    for (auto& entry : snapshot.entries)
+    {
+        entry.position.x = ::quantise(entry.position.x);
+        entry.position.y = ::quantise(entry.position.y);
+    }
+}
+
+void SnapshotCodec::write(sf::Packet& packet, const Snapshot& current, const Snapshot* baseline)
+{
+    sf::Uint16 baselineOffset = baseline ? current.sequence - baseline->sequence : 0;
+    if (baselineOffset >= SnapshotHistory::Size)
+    {
+        baseline = nullptr;
+        baselineOffset = 0;
+    }
+
+    //scratch space is kept between calls so that steady state
+    //encoding doesn't allocate
+    thread_local std::vector<std::pair<const Snapshot::Entry*, sf::Uint8>> changes;
+    thread_local std::vector<sf::Uint16> removed;
+    thread_local BitWriter writer;
+    changes.clear();
+    removed.clear();
+    writer.clear();
+
+    //changed or new entries
+    sf::Uint16 maxSlot = 0;
+    for (const auto& entry : current.entries)
+    {
+        const auto* old = baseline ? baseline->find(entry.slot) : nullptr;
+        if (!old)
+        {
+            changes.emplace_back(&entry, sf::Uint8(FieldFlags::All));
+            maxSlot = std::max(maxSlot, entry.slot);
+        }
+        else
+        {
+            sf::Uint8 mask = 0;
+            if (old->position.x != entry.position.x) mask |= FieldFlags::PositionX;
+            if (old->position.y != entry.position.y) mask |= FieldFlags::PositionY;
+            if (old->direction != entry.direction) mask |= FieldFlags::Heading;
+            if (mask)
+            {
+                changes.emplace_back(&entry, mask);
+                maxSlot = std::max(maxSlot, entry.slot);
+            }
+        }
+    }
+
+    //entries which have left since the baseline
+    if (baseline)
+    {
+        for (const auto& entry : baseline->entries)
+        {
+            if (!current.find(entry.slot))
+            {
+                removed.push_back(entry.slot);
+                maxSlot = std::max(maxSlot, entry.slot);
+            }
+        }
+    }
+
+    //slots are small so only write as many bits as the largest needs.
+    //slots are unique, so neither list can hold more than maxSlot + 1
+    //entries, and the counts always fit in one more bit than a slot
+    auto slotBits = Bits::required(maxSlot);
+    XY_ASSERT(slotBits < (1 << slotSizeBits), "Slot out of range");
+    const sf::Uint8 countBits = slotBits + 1;
+    XY_ASSERT(changes.size() < (1u << countBits) && removed.size() < (1u << countBits), "Snapshot count out of range");
+
+    writer.write(current.sequence, 16);
+    writer.write(baselineOffset, baselineBits);
+    writer.write(slotBits, slotSizeBits);
+
+    writer.write(static_cast<sf::Uint32>(changes.size()), countBits);
+    for (const auto& change : changes)
+    {
+        const auto& entry = *change.first;
+        writer.write(entry.slot, slotBits);
+        writer.write(change.second, fieldBits);
+        if (change.second & FieldFlags::PositionX) writer.writeQuantised(entry.position.x, positionMin, positionMax, positionPrecision);
+        if (change.second & FieldFlags::PositionY) writer.writeQuantised(entry.position.y, positionMin, positionMax, positionPrecision);
+        if (change.second & FieldFlags::Heading) writer.write(static_cast<sf::Uint32>(entry.direction), directionBits);
+    }
+
+    writer.write(static_cast<sf::Uint32>(removed.size()), countBits);
+    for (auto slot : removed) writer.write(slot, slotBits);
+
+    packet << writer;
+}
+
+bool SnapshotCodec::read(sf::Packet& packet, const SnapshotHistory& history, Snapshot& dest)
+{
+    BitReader reader;
+    packet >> reader;
+
+    auto sequence = static_cast<xy::Network::SeqID>(reader.read(16));
+    auto baselineOffset = reader.read(baselineBits);
+    auto slotBits = static_cast<sf::Uint8>(reader.read(slotSizeBits));
+    const sf::Uint8 countBits = slotBits + 1;
+    //slots are 16 bit, and there can't be more entries than slots, so
+    //anything larger is a corrupt packet which would take ages to read
+    const sf::Uint32 maxCount = 1u << slotBits;
+    if (!reader.valid() || slotBits > 16) return false;
+
+    if (baselineOffset == 0)
+    {
+        dest.clear();
+    }
+    else
+    {
+        const auto* baseline = history.get(static_cast<xy::Network::SeqID>(sequence - baselineOffset));
+        if (!baseline) return false;
+        dest.entries = baseline->entries;
+    }
+    dest.sequence = sequence;
+
+    auto count = reader.read(countBits);
+    if (count > maxCount) return false;
+    for (auto i = 0u; i < count && reader.valid(); ++i)
+    {
+        Snapshot::Entry entry;
+        entry.slot = static_cast<sf::Uint16>(reader.read(slotBits));
+        auto mask = reader.read(fieldBits);
+
+        if (const auto* old = dest.find(entry.slot))
+        {
+            entry = *old;
+        }
+        if (mask & FieldFlags::PositionX) entry.position.x = reader.readQuantised(positionMin, positionMax, positionPrecision);
+        if (mask & FieldFlags::PositionY) entry.position.y = reader.readQuantised(positionMin, positionMax, positionPrecision);
+        if (mask & FieldFlags::Heading) entry.direction = static_cast<Direction>(reader.read(directionBits));
+        dest.add(entry);
+    }
+
+    count = reader.read(countBits);
+    if (count > maxCount) return false;
+    for (auto i = 0u; i < count && reader.valid(); ++i)
+    {
+        auto slot = static_cast<sf::Uint16>(reader.read(slotBits));
+        dest.entries.erase(std::remove_if(dest.entries.begin(), dest.entries.end(),
+            [slot](const Snapshot::Entry& e) {return e.slot == slot; }), dest.entries.end());
+    }
+
+    return reader.valid();
+}
\ No newline at end of file
@@ -0,0 +1,293 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+#include <TickProfiler.hpp>
+
+#include <xygine/Log.hpp>
+#include <xygine/Reports.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+namespace
+{
+    const std::array<std::string, TickProfiler::Phase::Count> phaseNames =
+    {
+        "messages",
+        "scene",
+        "connection",
+        "replication",
+        "tick"
+    };
+
+    const float defaultInterval = 5.f;
+}
+
+//---------------------------------------------------------
+LatencyHistogram::LatencyHistogram()
+    : m_count   (0),
+    m_max       (0),
+    m_total     (0)
+{
+    m_counts.fill(0);
+}
+
+//public
+void LatencyHistogram::record(sf::Uint32 value)
+{
+    m_counts[indexOf(value)]++;
+    m_count++;
+    m_max = std::max(m_max, value);
+    m_total += value;
+}
+
+void LatencyHistogram::reset()
+{
+    m_counts.fill(0);
+    m_count = 0;
+    m_max = 0;
+    m_total = 0;
+}
+
+sf::Uint32 LatencyHistogram::getPercentile(float percentile) const
+{
+    if (m_count == 0) return 0;
+
+    auto target = static_cast<sf::Uint32>(std::ceil(std::max(0.f, std::min(1.f, percentile)) * m_count));
+    target = std::max(1u, target);
+
+    sf::Uint32 total = 0;
+    for (auto i = 0u; i < m_counts.size(); ++i)
+    {
+        total += m_counts[i];
+        if (total >= target)
+        {
+            return std::min(valueOf(i), m_max);
+        }
+    }
+    return m_max;
+}
+
+float LatencyHistogram::getMean() const
+{
+    return (m_count > 0) ? static_cast<float>(m_total) / m_count : 0.f;
+}
+
+//private
+std::size_t LatencyHistogram::indexOf(sf::Uint32 value)
+{
+    //the first bucket holds small values exactly, each one after
+    //covers twice the range of the last with the same number of steps
+    if (value < SubBucketCount) return value;
+
+    sf::Uint32 msb = SubBucketBits;
+    while (value >> (msb + 1)) msb++;
+
+    auto bucket = msb - SubBucketBits + 1;
+    if (bucket > BucketCount) return (BucketCount * SubBucketCount) + (SubBucketCount - 1);
+
+    auto shift = msb - SubBucketBits;
+    auto subBucket = (value >> shift) - SubBucketCount;
+    return (bucket * SubBucketCount) + subBucket;
+}
+
+sf::Uint32 LatencyHistogram::valueOf(std::size_t index)
+{
+    //upper edge of the range covered by the index
+    auto bucket = static_cast<sf::Uint32>(index / SubBucketCount);
+    auto subBucket = static_cast<sf::Uint32>(index % SubBucketCount);
+    if (bucket == 0) return subBucket;
+
+    auto shift = bucket - 1;
+    return ((SubBucketCount + subBucket + 1) << shift) - 1;
+}
+
+//---------------------------------------------------------
+TickProfiler::TickProfiler()
+    : m_totalBytes  (0),
+    m_totalPackets  (0),
+    m_interval      (defaultInterval),
+    m_accumulator   (0.f),
+    m_uptime        (0.f),
+    m_writing       (false)
+{
+
+}
+
+TickProfiler::~TickProfiler()
+{
+    stopWriting();
+}
+
+//public
+void TickProfiler::setOutput(const std::string& path, float interval)
+{
+    stopWriting();
+
+    m_outputPath = path;
+    m_interval = std::max(1.f, interval);
+    if (m_outputPath.empty()) return;
+
+    m_file.open(m_outputPath, std::ios::app);
+    if (!m_file.good())
+    {
+        LOG("Failed opening " + m_outputPath + " for profiler output, disabling dump", xy::Logger::Type::Error);
+        m_outputPath.clear();
+        m_file.close();
+        m_file.clear();
+        return;
+    }
+
+    m_writing = true;
+    m_writeThread = std::thread(&TickProfiler::writeFunc, this);
+}
+
+void TickProfiler::addTraffic(xy::ClientID id, std::size_t bytes)
+{
+    auto& traffic = m_traffic[id];
+    traffic.bytes += bytes;
+    traffic.packets++;
+    m_totalBytes += bytes;
+    m_totalPackets++;
+}
+
+void TickProfiler::removeClient(xy::ClientID id)
+{
+    m_traffic.erase(id);
+}
+
+void TickProfiler::update(float dt)
+{
+    m_uptime += dt;
+    m_accumulator += dt;
+    if (m_accumulator < m_interval) return;
+
+    for (auto& t : m_traffic)
+    {
+        auto& traffic = t.second;
+        traffic.bytesPerSecond = traffic.bytes / m_accumulator;
+        traffic.packetsPerSecond = traffic.packets / m_accumulator;
+    }
+
+    report();
+    if (!m_outputPath.empty()) dump();
+
+    //each interval is reported on its own so spikes aren't averaged away
+    for (auto& h : m_histograms) h.reset();
+    for (auto& t : m_traffic)
+    {
+        t.second.bytes = 0;
+        t.second.packets = 0;
+    }
+    m_accumulator = 0.f;
+}
+
+//private
+void TickProfiler::stopWriting()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        if (!m_writing) return;
+        m_writing = false;
+    }
+    m_writeCondition.notify_one();
+    m_writeThread.join();
+    m_file.close();
+}
+
+void TickProfiler::writeFunc()
+{
+    bool writing = true;
+    while (writing)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_writeMutex);
+            m_writeCondition.wait(lock, [this]() { return !m_writing || !m_pendingOutput.empty(); });
+            writing = m_writing;
+            m_writeOutput.swap(m_pendingOutput);
+        }
+
+        if (!m_writeOutput.empty())
+        {
+            m_file << m_writeOutput;
+            m_file.flush();
+            m_writeOutput.clear();
+        }
+    }
+}
+
+void TickProfiler::dump()
+{
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(1);
+    report << "[" << m_uptime << "s]\n";
+    for (auto i = 0u; i < m_histograms.size(); ++i)
+    {
+        const auto& h = m_histograms[i];
+        report << phaseNames[i] << " (us): count " << h.getCount()
+            << " mean " << h.getMean()
+            << " p50 " << h.getPercentile(0.5f)
+            << " p90 " << h.getPercentile(0.9f)
+            << " p99 " << h.getPercentile(0.99f)
+            << " p99.9 " << h.getPercentile(0.999f)
+            << " max " << h.getMax() << "\n";
+    }
+    for (const auto& t : m_traffic)
+    {
+        report << "client " << t.first << ": " << t.second.bytesPerSecond << " B/s "
+            << t.second.packetsPerSecond << " packets/s\n";
+    }
+    report << "\n";
+
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        m_pendingOutput += report.str();
+    }
+    m_writeCondition.notify_one();
+}
+
+void TickProfiler::report()
+{
+#ifdef _DEBUG_
+    const auto& tick = m_histograms[Phase::Tick];
+    REPORT("Server tick (us)", "p50: " + std::to_string(tick.getPercentile(0.5f))
+        + " p99: " + std::to_string(tick.getPercentile(0.99f))
+        + " max: " + std::to_string(tick.getMax()));
+
+    for (const auto& t : m_traffic)
+    {
+        REPORT("Client " + std::to_string(t.first) + " traffic",
+            std::to_string(static_cast<int>(t.second.bytesPerSecond)) + "B/s, "
+            + std::to_string(static_cast<int>(t.second.packetsPerSecond)) + " packets/s");
+    }
+#endif //_DEBUG_
+}
@@ -28,15 +28,13 @@ source distribution.
 -----------------------------------------------------------------------*/
 
 #include <components/Tilemap.hpp>
+#include <AssetManager.hpp>
 
-#include <xygine/util/Json.hpp>
 #include <xygine/util/Random.hpp>
-#include <xygine/parsers/picojson.h>
 
 #include <SFML/Graphics/RenderStates.hpp>
 #include <SFML/Graphics/RenderTarget.hpp>
 
-#include <fstream>
 #include <bitset>
 #include <functional>
 
@@ -56,13 +54,11 @@ namespace
 //actually we probably only need to store positions
 std::vector<sf::Vector2f> Tilemap::tilePositions(Tilemap::Count);
 
-Tilemap::Tilemap(xy::MessageBus& mb, sf::Texture& texture)
+Tilemap::Tilemap(xy::MessageBus& mb, sf::Texture& texture, const TileSet& tileSet)
     : xy::Component (mb, this),
     m_texture       (texture)
 {
-    //shouldn't really be loading stuff in a ctor
-    //but buns to it. We'll just fail gracefully.
-    loadJson();
+    loadTiles(tileSet);
     buildMap();
 }
 
@@ -70,82 +66,35 @@ Tilemap::Tilemap(xy::MessageBus& mb, sf::Texture& texture)
 void Tilemap::entityUpdate(xy::Entity&, float) {}
 
 //private
-void Tilemap::loadJson()
+void Tilemap::loadTiles(const TileSet& tileSet)
 {
-    std::ifstream file("assets/images/tileset.tst");
-    if (file.good() && xy::Util::File::validLength(file))
-    {
-        std::string jsonString;
-        std::string temp;
-        while (!file.eof())
-        {
-            file >> temp;
-            jsonString += temp;
-        }
-        if (!jsonString.empty())
-        {
-            picojson::value rootValue;
-            auto err = picojson::parse(rootValue, jsonString);
-            if (err.empty())
-            {
-                getValue("short1", rootValue, Tile::ShortGrassLight);
-                getValue("short2", rootValue, Tile::ShortGrassDark);
-                getValue("fence_tl", rootValue, Tile::FenceTopLeft);
-                getValue("fence_top", rootValue, Tile::FenceTop);
-                getValue("fence_tr", rootValue, Tile::FenceTopRight);
-                getValue("long", rootValue, Tile::LongGrass);
-                getValue("dirt", rootValue, Tile::Dirt);
-                getValue("fence_bl", rootValue, Tile::FenceBottomLeft);
-                getValue("fence_bottom", rootValue, Tile::FenceBottom);
-                getValue("fence_br", rootValue, Tile::FenceBottomRight);
-                getValue("fence_left", rootValue, Tile::FenceLeft);
-                getValue("fence_right", rootValue, Tile::FenceRight);
-                getValue("edge_n", rootValue, Tile::EdgeNorth);
-                getValue("edge_e", rootValue, Tile::EdgeEast);
-                getValue("edge_s", rootValue, Tile::EdgeSouth);
-                getValue("edge_w", rootValue, Tile::EdgeWest);
-                getValue("edge_ne", rootValue, Tile::EdgeNorthEast);
-                getValue("edge_se", rootValue, Tile::EdgeSouthEast);
-                getValue("edge_sw", rootValue, Tile::EdgeSouthWest);
-                getValue("edge_nw", rootValue, Tile::EdgeNorthWest);
-                getValue("flower1", rootValue, Tile::FlowersOne);
-                getValue("flower2", rootValue, Tile::FlowersTwo);
-                getValue("flower3", rootValue, Tile::FlowersThree);
-                getValue("flower4", rootValue, Tile::FlowersFour);
-                getValue("rock1", rootValue, Tile::RockOne);
-                getValue("rock2", rootValue, Tile::RockTwo);
-                getValue("rock3", rootValue, Tile::RockThree);
-            }
-            else
-            {
-                xy::Logger::log("tileset data: " + err, xy::Logger::Type::Error, xy::Logger::Output::All);
-            }
-        }
-        else
-        {
-            xy::Logger::log("tileset data file is empty", xy::Logger::Type::Error, xy::Logger::Output::All);
-        }
-    }
-    else
-    {
-        //always write this, and write to log file so we can see this in release builds
-        xy::Logger::log("failed to open tileset data file.", xy::Logger::Type::Error, xy::Logger::Output::All);
-    }
-    file.close();
-}
-
-void Tilemap::getValue(const std::string& name, const picojson::value& source, Tilemap::Tile tile)
-{
-    if (source.get(name).is<picojson::array>())
-    {
-        auto arr = source.get(name).get<picojson::array>();
-        sf::Vector2f pos
-            (
-                arr[0].is<double>() ? static_cast<float>(arr[0].get<double>()) : 0.f,
-                arr[1].is<double>() ? static_cast<float>(arr[1].get<double>()) : 0.f
-                );
-        tilePositions[tile] = pos;
-    }
+    tilePositions[Tile::ShortGrassLight] = tileSet.get("short1");
+    tilePositions[Tile::ShortGrassDark] = tileSet.get("short2");
+    tilePositions[Tile::FenceTopLeft] = tileSet.get("fence_tl");
+    tilePositions[Tile::FenceTop] = tileSet.get("fence_top");
+    tilePositions[Tile::FenceTopRight] = tileSet.get("fence_tr");
+    tilePositions[Tile::LongGrass] = tileSet.get("long");
+    tilePositions[Tile::Dirt] = tileSet.get("dirt");
+    tilePositions[Tile::FenceBottomLeft] = tileSet.get("fence_bl");
+    tilePositions[Tile::FenceBottom] = tileSet.get("fence_bottom");
+    tilePositions[Tile::FenceBottomRight] = tileSet.get("fence_br");
+    tilePositions[Tile::FenceLeft] = tileSet.get("fence_left");
+    tilePositions[Tile::FenceRight] = tileSet.get("fence_right");
+    tilePositions[Tile::EdgeNorth] = tileSet.get("edge_n");
+    tilePositions[Tile::EdgeEast] = tileSet.get("edge_e");
+    tilePositions[Tile::EdgeSouth] = tileSet.get("edge_s");
+    tilePositions[Tile::EdgeWest] = tileSet.get("edge_w");
+    tilePositions[Tile::EdgeNorthEast] = tileSet.get("edge_ne");
+    tilePositions[Tile::EdgeSouthEast] = tileSet.get("edge_se");
+    tilePositions[Tile::EdgeSouthWest] = tileSet.get("edge_sw");
+    tilePositions[Tile::EdgeNorthWest] = tileSet.get("edge_nw");
+    tilePositions[Tile::FlowersOne] = tileSet.get("flower1");
+    tilePositions[Tile::FlowersTwo] = tileSet.get("flower2");
+    tilePositions[Tile::FlowersThree] = tileSet.get("flower3");
+    tilePositions[Tile::FlowersFour] = tileSet.get("flower4");
+    tilePositions[Tile::RockOne] = tileSet.get("rock1");
+    tilePositions[Tile::RockTwo] = tileSet.get("rock2");
+    tilePositions[Tile::RockThree] = tileSet.get("rock3");
 }
 
 void Tilemap::buildMap()
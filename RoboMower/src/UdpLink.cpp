@@ -0,0 +1,189 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+#include <UdpLink.hpp>
+
+#include <SFML/Network/Packet.hpp>
+
+#include <thread>
+
+//---------------------------------------------------------
+InboundQueue::InboundQueue()
+    : m_open(true)
+{
+
+}
+
+//public
+void InboundQueue::push(xy::ClientID id, xy::Network::PacketType type, const sf::Packet& packet)
+{
+    if (!m_producerItem.packet) m_producerItem.packet = std::make_unique<sf::Packet>();
+
+    m_producerItem.clientID = id;
+    m_producerItem.type = type;
+    //copying also keeps the read position, so the packet ID stays consumed
+    *m_producerItem.packet = packet;
+
+    while (!m_queue.push(m_producerItem))
+    {
+        if (!m_open) return;
+        std::this_thread::yield();
+    }
+}
+
+void InboundQueue::reset()
+{
+    while (m_queue.pop(m_consumerItem)) {}
+    m_open = true;
+}
+
+void InboundQueue::drain(const Handler& handler)
+{
+    while (m_queue.pop(m_consumerItem))
+    {
+        if (handler) handler(m_consumerItem.clientID, m_consumerItem.type, *m_consumerItem.packet);
+    }
+}
+
+//---------------------------------------------------------
+UdpClientLink::UdpClientLink(const sf::IpAddress& address, xy::PortNumber port)
+{
+    m_connection.setPacketHandler([this](xy::Network::PacketType type, sf::Packet& packet, xy::Network::ClientConnection* connection)
+    {
+        m_inbound.push(connection->getClientID(), type, packet);
+    });
+    m_connection.setServerInfo(address, port);
+}
+
+UdpClientLink::~UdpClientLink()
+{
+    m_inbound.close();
+    m_connection.removePacketHandler();
+}
+
+//public
+bool UdpClientLink::connect()
+{
+    if (!m_connection.connected()) m_inbound.reset();
+    return m_connection.connect();
+}
+
+void UdpClientLink::disconnect()
+{
+    m_inbound.close();
+    m_connection.disconnect();
+}
+
+void UdpClientLink::update(float dt)
+{
+    m_inbound.drain([this](xy::ClientID, xy::Network::PacketType type, sf::Packet& packet)
+    {
+        if (m_packetHandler) m_packetHandler(type, packet);
+    });
+    m_connection.update(dt);
+}
+
+bool UdpClientLink::send(sf::Packet& packet, bool reliable)
+{
+    return m_connection.send(packet, reliable);
+}
+
+bool UdpClientLink::connected() const
+{
+    return m_connection.connected();
+}
+
+xy::ClientID UdpClientLink::getClientID() const
+{
+    return m_connection.getClientID();
+}
+
+sf::Time UdpClientLink::getTime() const
+{
+    return m_connection.getTime();
+}
+
+//---------------------------------------------------------
+UdpServerLink::UdpServerLink(xy::MessageBus& mb)
+    : m_connection(mb)
+{
+    m_connection.setPacketHandler([this](const sf::IpAddress& ip, xy::PortNumber port, xy::Network::PacketType type, sf::Packet& packet, xy::Network::ServerConnection* connection)
+    {
+        //looked up now as the client may have gone by the time the packet is handled
+        m_inbound.push(connection->getClientID(ip, port), type, packet);
+    });
+    m_connection.setTimeoutHandler([this](xy::ClientID id)
+    {
+        if (m_timeoutHandler) m_timeoutHandler(id);
+    });
+}
+
+UdpServerLink::~UdpServerLink()
+{
+    stop();
+}
+
+//public
+bool UdpServerLink::start()
+{
+    m_inbound.reset();
+    return m_connection.start();
+}
+
+void UdpServerLink::stop()
+{
+    m_inbound.close();
+    m_connection.stop();
+}
+
+void UdpServerLink::update(float dt)
+{
+    m_inbound.drain(m_packetHandler);
+    m_connection.update(dt);
+}
+
+bool UdpServerLink::send(xy::ClientID id, sf::Packet& packet, bool reliable)
+{
+    return m_connection.send(id, packet, reliable);
+}
+
+void UdpServerLink::broadcast(sf::Packet& packet, bool reliable)
+{
+    m_connection.broadcast(packet, reliable);
+}
+
+void UdpServerLink::setMaxClients(std::size_t count)
+{
+    m_connection.setMaxClients(count);
+}
+
+std::unique_ptr<ClientLink> UdpServerLink::createLocalClient()
+{
+    return std::make_unique<UdpClientLink>(sf::IpAddress::LocalHost, xy::Network::ServerPort);
+}
@@ -28,18 +28,65 @@ source distribution.
 -----------------------------------------------------------------------*/
 
 #include <Game.hpp>
+#include <LaunchOptions.hpp>
+#include <ReplayPlayer.hpp>
+
+#include <xygine/Log.hpp>
+
+#include <SFML/System/Clock.hpp>
+#include <SFML/System/Sleep.hpp>
 
 #ifdef __linux
 #include <X11/Xlib.h>
 #endif // __linux
 
-int main()
+namespace
+{
+    //plays back a recorded session without a window, and returns non-zero if it diverged
+    int playReplay(const LaunchOptions& options)
+    {
+        ReplayPlayer player;
+        if (!player.load(options.replayPath)) return 1;
+
+        sf::Clock clock;
+        if (options.replaySpeed > 0.f)
+        {
+            player.setSpeed(options.replaySpeed);
+            sf::Clock frameClock;
+            while (!player.finished())
+            {
+                player.update(frameClock.restart().asSeconds());
+                sf::sleep(sf::milliseconds(1));
+            }
+        }
+        else
+        {
+            player.runToEnd();
+        }
+
+        const auto& summary = player.getSummary();
+        //logged directly so the result is reported in release builds too
+        xy::Logger::log("Replayed " + std::to_string(summary.duration / 1000.f) + "s session in "
+            + std::to_string(clock.getElapsedTime().asSeconds()) + "s: " + std::to_string(summary.events) + " events, "
+            + std::to_string(summary.checkpoints) + " checkpoints, " + std::to_string(summary.mismatches) + " mismatches", xy::Logger::Type::Info);
+
+        return (summary.mismatches == 0) ? 0 : 1;
+    }
+}
+
+int main(int argc, char** argv)
 {
+    auto options = LaunchOptions::parse(argc, argv);
+    if (!options.replayPath.empty())
+    {
+        return playReplay(options);
+    }
+
 #ifdef __linux
     XInitThreads();
 #endif //__linux
 
-    Game game;
+    Game game(options);
     game.run();
 
     return 0;
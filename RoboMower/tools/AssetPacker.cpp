@@ -0,0 +1,265 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+//packs every file named in the asset manifest, plus the manifest itself,
+//into a single archive which the game memory maps at start up. Paths are
+//stored exactly as the manifest names them, so the game finds them in the
+//archive under the same names it would open from disk.
+//
+//usage: robomower-packer [--manifest=path] [--output=path] [--lz4]
+
+#include <AssetArchive.hpp>
+
+#include <xygine/parsers/picojson.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <set>
+#include <string>
+#include <vector>
+
+#ifdef RM_USE_LZ4
+#include <lz4.h>
+#endif //RM_USE_LZ4
+
+namespace
+{
+    struct Options final
+    {
+        std::string manifest = "assets/manifest.json";
+        std::string output = "assets.pak";
+        bool compress = false;
+    };
+
+    struct File final
+    {
+        std::string path;
+        std::vector<char> data;
+        sf::Uint64 size = 0;
+        sf::Uint8 flags = 0;
+    };
+
+    Options parseOptions(int argc, char** argv)
+    {
+        Options options;
+        for (auto i = 1; i < argc; ++i)
+        {
+            std::string arg(argv[i]);
+            if (arg.compare(0, 11, "--manifest=") == 0)
+            {
+                options.manifest = arg.substr(11);
+            }
+            else if (arg.compare(0, 9, "--output=") == 0)
+            {
+                options.output = arg.substr(9);
+            }
+            else if (arg == "--lz4")
+            {
+                options.compress = true;
+            }
+            else
+            {
+                std::cerr << "Unknown argument " << arg << std::endl;
+            }
+        }
+        return options;
+    }
+
+    bool readFile(const std::string& path, std::vector<char>& dest)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.good()) return false;
+
+        dest.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    //returns the paths of all assets in the manifest, sorted so the
+    //archive is the same each time it's built from the same files
+    bool readManifest(const std::string& path, std::set<std::string>& dest)
+    {
+        std::vector<char> data;
+        if (!readFile(path, data))
+        {
+            std::cerr << "Failed to open " << path << std::endl;
+            return false;
+        }
+
+        picojson::value rootValue;
+        std::string err;
+        picojson::parse(rootValue, data.begin(), data.end(), &err);
+        if (!err.empty() || !rootValue.is<picojson::object>())
+        {
+            std::cerr << path << ": " << err << std::endl;
+            return false;
+        }
+
+        dest.insert(path);
+        for (const auto& section : { "textures", "fonts", "tilesets", "particles" })
+        {
+            if (!rootValue.get(section).is<picojson::object>()) continue;
+            for (const auto& asset : rootValue.get(section).get<picojson::object>())
+            {
+                //empty paths are xygine's built in assets
+                if (asset.second.is<std::string>() && !asset.second.get<std::string>().empty())
+                {
+                    dest.insert(asset.second.get<std::string>());
+                }
+            }
+        }
+        return true;
+    }
+
+    void compress(File& file)
+    {
+#ifdef RM_USE_LZ4
+        std::vector<char> compressed(LZ4_compressBound(static_cast<int>(file.data.size())));
+        auto size = LZ4_compress_default(file.data.data(), compressed.data(),
+            static_cast<int>(file.data.size()), static_cast<int>(compressed.size()));
+
+        //images and fonts are often compressed already, so only
+        //keep the result if it's actually worth decompressing
+        if (size > 0 && static_cast<std::size_t>(size) < file.data.size() - file.data.size() / 8)
+        {
+            compressed.resize(size);
+            file.data.swap(compressed);
+            file.flags |= AssetArchive::Compressed;
+        }
+#endif //RM_USE_LZ4
+    }
+
+    template <typename T>
+    void writeValue(std::vector<char>& dest, T value)
+    {
+        for (auto i = 0u; i < sizeof(T); ++i)
+        {
+            dest.push_back(static_cast<char>((value >> (i * 8)) & 0xff));
+        }
+    }
+
+    sf::Uint64 align(sf::Uint64 offset)
+    {
+        return (offset + AssetArchive::Alignment - 1) / AssetArchive::Alignment * AssetArchive::Alignment;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    auto options = parseOptions(argc, argv);
+    if (options.compress && !AssetArchive::compressionAvailable())
+    {
+        std::cerr << "Built without LZ4, assets will be stored uncompressed" << std::endl;
+        options.compress = false;
+    }
+
+    std::set<std::string> paths;
+    if (!readManifest(options.manifest, paths)) return 1;
+
+    std::vector<File> files;
+    for (const auto& path : paths)
+    {
+        File file;
+        file.path = path;
+        if (!readFile(path, file.data))
+        {
+            //the game falls back to the same missing file on disk, so carry on
+            std::cerr << "Skipping " << path << ", failed to open" << std::endl;
+            continue;
+        }
+        if (path.size() > 0xffff)
+        {
+            std::cerr << "Skipping " << path << ", path too long" << std::endl;
+            continue;
+        }
+        file.size = file.data.size();
+        if (options.compress) compress(file);
+        files.push_back(std::move(file));
+    }
+
+    //the index size is needed before blob offsets can be worked out
+    sf::Uint32 indexSize = 0;
+    for (const auto& file : files)
+    {
+        indexSize += static_cast<sf::Uint32>(sizeof(sf::Uint16) + file.path.size() + sizeof(sf::Uint8) + sizeof(sf::Uint64) * 3);
+    }
+
+    std::vector<char> index;
+    index.insert(index.end(), { 'R', 'M', 'P', 'K' });
+    writeValue(index, AssetArchive::Version);
+    writeValue(index, static_cast<sf::Uint32>(files.size()));
+    writeValue(index, indexSize);
+
+    std::vector<sf::Uint64> offsets;
+    auto offset = align(AssetArchive::HeaderSize + indexSize);
+    for (const auto& file : files)
+    {
+        offsets.push_back(offset);
+        writeValue(index, static_cast<sf::Uint16>(file.path.size()));
+        index.insert(index.end(), file.path.begin(), file.path.end());
+        writeValue(index, file.flags);
+        writeValue(index, offset);
+        writeValue(index, static_cast<sf::Uint64>(file.data.size()));
+        writeValue(index, file.size);
+        offset = align(offset + file.data.size());
+    }
+
+    std::ofstream output(options.output, std::ios::binary);
+    if (!output.good())
+    {
+        std::cerr << "Failed to open " << options.output << " for writing" << std::endl;
+        return 1;
+    }
+
+    output.write(index.data(), index.size());
+    sf::Uint64 written = index.size();
+    sf::Uint64 totalSize = 0, storedSize = 0;
+    for (auto i = 0u; i < files.size(); ++i)
+    {
+        static const std::vector<char> padding(AssetArchive::Alignment, 0);
+        output.write(padding.data(), offsets[i] - written);
+        output.write(files[i].data.data(), files[i].data.size());
+        written = offsets[i] + files[i].data.size();
+
+        totalSize += files[i].size;
+        storedSize += files[i].data.size();
+        std::cout << files[i].path << ": " << files[i].size << " bytes";
+        if (files[i].flags & AssetArchive::Compressed) std::cout << " (" << files[i].data.size() << " compressed)";
+        std::cout << std::endl;
+    }
+
+    if (!output.good())
+    {
+        std::cerr << "Failed writing " << options.output << std::endl;
+        return 1;
+    }
+    std::cout << "Packed " << files.size() << " files, " << totalSize << " bytes (" << storedSize << " stored) into " << options.output << std::endl;
+    return 0;
+}
@@ -0,0 +1,427 @@
+/*-----------------------------------------------------------------------
+
+Matt Marchant 2015 - 2016
+http://trederia.blogspot.com
+
+Robomower - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty.In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions :
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+
+-----------------------------------------------------------------------*/
+
+//load tester which runs a GameServer with hundreds of bot clients in the
+//same process. Bots connect over loopback UDP and behave like players,
+//submitting random programs and pressing play, pause and rewind.
+//Raising the program length makes uploads span several fragments.
+//
+//usage: robomower-loadtest [--bots=N] [--duration=seconds] [--replication=events|snapshots]
+//                          [--program-length=instructions]
+
+#include <GameServer.hpp>
+#include <NetProtocol.hpp>
+#include <PacketEnums.hpp>
+#include <ProgramStore.hpp>
+#include <BulkTransfer.hpp>
+#include <Snapshot.hpp>
+#include <TickProfiler.hpp>
+#include <InstructionSet.hpp>
+#include <UdpLink.hpp>
+
+#include <SFML/System/Clock.hpp>
+#include <SFML/System/Sleep.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef __linux
+#include <unistd.h>
+#endif //__linux
+
+namespace
+{
+    const float tickRate = 1.f / 60.f;
+    const float reportInterval = 1.f;
+    //connecting everyone at once just measures the handshake
+    const std::size_t connectsPerTick = 10;
+
+    struct Stats final
+    {
+        sf::Uint64 packetsReceived = 0;
+        sf::Uint64 bytesReceived = 0;
+        sf::Uint64 snapshotBytes = 0;
+        sf::Uint64 snapshots = 0;
+        sf::Uint64 uploads = 0;
+        sf::Uint64 programsSent = 0;
+        sf::Uint64 programsStarted = 0;
+        sf::Uint64 programsRejected = 0;
+        sf::Uint32 connected = 0;
+    };
+
+    std::size_t residentMemory()
+    {
+#ifdef __linux
+        std::ifstream statm("/proc/self/statm");
+        std::size_t size = 0, resident = 0;
+        statm >> size >> resident;
+        return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#else
+        return 0;
+#endif //__linux
+    }
+
+    class Bot final
+    {
+    public:
+        Bot(std::size_t index, Stats& stats, sf::Uint32 seed, std::size_t programLength)
+            : m_index       (index),
+            m_stats         (stats),
+            m_programLength (programLength),
+            m_random        (seed),
+            m_link          (sf::IpAddress::LocalHost, xy::Network::ServerPort),
+            m_connected     (false),
+            m_joined        (false),
+            m_uploadRequested(false),
+            m_finished      (false),
+            m_actionTimer   (0.f)
+        {
+            //the link queues packets until it's updated, so they're
+            //handled on the same thread as everything else the bot does
+            m_link.setPacketHandler([this](xy::Network::PacketType type, sf::Packet& packet)
+            {
+                handlePacket(type, packet);
+            });
+            m_bulkTransfer.setSendFunction([this](sf::Packet& packet) { m_link.send(packet, false); });
+        }
+
+        void connect() { m_link.connect(); }
+
+        void update(float dt)
+        {
+            m_link.update(dt);
+            m_bulkTransfer.update(dt);
+            if (!m_connected) return;
+
+            if (!m_joined)
+            {
+                m_joined = true;
+                m_bulkTransfer.setClientID(m_link.getClientID());
+
+                sf::Packet packet;
+                packet << PacketIdent::PlayerDetails << m_link.getClientID() << ("bot_" + std::to_string(m_index));
+                m_link.send(packet, true);
+
+                submitProgram(true);
+                return;
+            }
+
+            if (m_uploadRequested)
+            {
+                m_uploadRequested = false;
+                m_stats.uploads++;
+                m_bulkTransfer.send(BulkChannel::Program, m_program);
+            }
+
+            //finished bots either replay their program or write a new one
+            if (m_finished)
+            {
+                m_finished = false;
+                sendTransport(TransportChange::Rewind);
+                submitProgram(std::uniform_int_distribution<int>(0, 3)(m_random) == 0);
+                return;
+            }
+
+            m_actionTimer -= dt;
+            if (m_actionTimer < 0.f)
+            {
+                m_actionTimer = std::uniform_real_distribution<float>(1.f, 10.f)(m_random);
+                switch (std::uniform_int_distribution<int>(0, 2)(m_random))
+                {
+                default:
+                case 0: sendTransport(TransportChange::Pause); break;
+                case 1: sendTransport(TransportChange::Play); break;
+                case 2:
+                    sendTransport(TransportChange::Rewind);
+                    submitProgram(false);
+                    break;
+                }
+            }
+        }
+
+    private:
+        std::size_t m_index;
+        Stats& m_stats;
+        std::size_t m_programLength;
+        std::mt19937 m_random;
+
+        UdpClientLink m_link;
+        BulkTransfer m_bulkTransfer;
+        SnapshotHistory m_snapshots;
+        ProgramStore::Program m_program;
+
+        bool m_connected;
+        bool m_joined;
+        bool m_uploadRequested;
+        bool m_finished;
+        float m_actionTimer;
+
+        void submitProgram(bool newProgram)
+        {
+            if (newProgram || m_program.empty())
+            {
+                //same layout as GameUI::getProgram(), without loops
+                static const std::array<Instruction, 3> moves = { Instruction::Forward, Instruction::Right, Instruction::Left };
+                m_program = { sf::Uint8(Instruction::EngineOn), 0 };
+
+                auto length = std::uniform_int_distribution<std::size_t>(4, m_programLength)(m_random);
+                for (auto i = 0u; i < length; ++i)
+                {
+                    m_program.push_back(sf::Uint8(moves[std::uniform_int_distribution<int>(0, 2)(m_random)]));
+                    m_program.push_back(sf::Uint8(std::uniform_int_distribution<int>(1, 4)(m_random)));
+                }
+            }
+
+            m_stats.programsSent++;
+            sf::Packet packet;
+            packet << PacketIdent::TransmitProgram << m_link.getClientID();
+            packet << ProgramStore::digest(m_program) << sf::Uint32(m_program.size());
+            m_link.send(packet, true);
+        }
+
+        void sendTransport(TransportChange change)
+        {
+            sf::Packet packet;
+            packet << PacketIdent::TransportRequestChange << m_link.getClientID() << change;
+            m_link.send(packet, true);
+        }
+
+        //called from update(). Messages unpacked from a batch
+        //aren't counted again, to match the server's totals
+        void handlePacket(xy::Network::PacketType type, sf::Packet& packet, bool batched = false)
+        {
+            if (static_cast<int>(type) >= PacketIdent::PlayerDetails && !batched)
+            {
+                m_stats.packetsReceived++;
+                m_stats.bytesReceived += packet.getDataSize();
+            }
+
+            switch (type)
+            {
+            default: break;
+            case xy::Network::Connect:
+                m_connected = true;
+                m_stats.connected++;
+                break;
+            case PacketIdent::PositionUpdate:
+            {
+                m_stats.snapshots++;
+                m_stats.snapshotBytes += packet.getDataSize();
+
+                float serverTime = 0.f;
+                sf::Uint32 tick = 0, hash = 0;
+                packet >> serverTime >> tick >> hash;
+                Snapshot snapshot;
+                if (!SnapshotCodec::read(packet, m_snapshots, snapshot)) break;
+                m_snapshots.insert(snapshot);
+
+                sf::Packet ack;
+                ack << PacketIdent::SnapshotAck << m_link.getClientID() << snapshot.sequence;
+                m_link.send(ack, false);
+            }
+                break;
+            case PacketIdent::TransportStateChanged:
+            {
+                TransportStatus status;
+                packet >> status;
+                if (status == TransportStatus::Playing) m_stats.programsStarted++;
+            }
+                break;
+            case PacketIdent::MessageBatch:
+                Batch::read(packet, [this](sf::Packet& message)
+                {
+                    xy::PacketID id;
+                    message >> id;
+                    handlePacket(static_cast<xy::Network::PacketType>(id), message, true);
+                });
+                break;
+            case PacketIdent::ProgramStatus:
+            {
+                ProgramState state;
+                packet >> state;
+                if (state == ProgramState::Upload) m_uploadRequested = true;
+                else if (state == ProgramState::Finished) m_finished = true;
+                else if (state == ProgramState::Rejected) m_stats.programsRejected++;
+                else if (state == ProgramState::Resend) submitProgram(false);
+            }
+                break;
+            case PacketIdent::Fragment:
+            case PacketIdent::FragmentStatus:
+            {
+                xy::ClientID id;
+                packet >> id;
+                m_bulkTransfer.handlePacket(type, packet);
+            }
+                break;
+            }
+        }
+    };
+
+    struct Options final
+    {
+        std::size_t bots = 200;
+        float duration = 60.f;
+        ReplicationMode replicationMode = ReplicationMode::Snapshots;
+        //instructions take two bytes, so anything over 512 needs more than one fragment
+        std::size_t programLength = 40;
+    };
+
+    Options parseOptions(int argc, char** argv)
+    {
+        Options options;
+        for (auto i = 1; i < argc; ++i)
+        {
+            std::string arg(argv[i]);
+            if (arg.compare(0, 7, "--bots=") == 0)
+            {
+                options.bots = std::strtoul(arg.c_str() + 7, nullptr, 10);
+            }
+            else if (arg.compare(0, 11, "--duration=") == 0)
+            {
+                options.duration = std::strtof(arg.c_str() + 11, nullptr);
+            }
+            else if (arg.compare(0, 17, "--program-length=") == 0)
+            {
+                options.programLength = std::max<std::size_t>(4, std::strtoul(arg.c_str() + 17, nullptr, 10));
+                options.programLength = std::min(options.programLength, (MaxProgramSize - 2) / 2);
+            }
+            else if (arg == "--replication=events")
+            {
+                options.replicationMode = ReplicationMode::Events;
+            }
+            else if (arg == "--replication=snapshots")
+            {
+                options.replicationMode = ReplicationMode::Snapshots;
+            }
+            else
+            {
+                std::cerr << "Unknown argument " << arg << std::endl;
+            }
+        }
+        return options;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    auto options = parseOptions(argc, argv);
+
+    GameServer server;
+    server.setReplicationMode(options.replicationMode);
+    server.setMaxClients(options.bots);
+    if (!server.start())
+    {
+        std::cerr << "Failed to start server" << std::endl;
+        return 1;
+    }
+
+    Stats stats;
+    std::vector<std::unique_ptr<Bot>> bots;
+    std::random_device rd;
+    for (auto i = 0u; i < options.bots; ++i)
+    {
+        bots.emplace_back(std::make_unique<Bot>(i, stats, rd(), options.programLength));
+    }
+
+    const auto startMemory = residentMemory();
+    LatencyHistogram tickTimes;
+    std::size_t connecting = 0;
+    sf::Uint64 lastBytes = 0, lastSnapshotBytes = 0, lastServerPackets = 0, lastReceived = 0;
+    float reportTime = 0.f;
+    float elapsed = 0.f;
+
+    std::cout << std::fixed << std::setprecision(1);
+    sf::Clock frameClock;
+    while (elapsed < options.duration)
+    {
+        for (auto i = 0u; i < connectsPerTick && connecting < bots.size(); ++i)
+        {
+            bots[connecting++]->connect();
+        }
+
+        sf::Clock tickClock;
+        server.update(tickRate);
+        tickTimes.record(static_cast<sf::Uint32>(tickClock.getElapsedTime().asMicroseconds()));
+
+        for (auto& bot : bots) bot->update(tickRate);
+
+        reportTime += tickRate;
+        elapsed += tickRate;
+        if (reportTime >= reportInterval)
+        {
+            //traffic counts only include game packets, not xygine's own heartbeats and acks
+            sf::Uint64 bytes = stats.bytesReceived;
+            sf::Uint64 snapshotBytes = stats.snapshotBytes;
+            sf::Uint64 received = stats.packetsReceived;
+            auto serverPackets = server.getProfiler().getTotalPackets();
+
+            auto sent = serverPackets - lastServerPackets;
+            auto loss = (sent > 0) ? 100.f * (1.f - std::min(1.f, static_cast<float>(received - lastReceived) / sent)) : 0.f;
+            auto memory = static_cast<float>(residentMemory()) - static_cast<float>(startMemory);
+
+            std::cout << "[" << elapsed << "s] clients: " << stats.connected
+                << " tick us p50: " << tickTimes.getPercentile(0.5f)
+                << " p99: " << tickTimes.getPercentile(0.99f)
+                << " max: " << tickTimes.getMax()
+                << " | KB/s total: " << (bytes - lastBytes) / 1024.f / reportTime
+                << " snapshots: " << (snapshotBytes - lastSnapshotBytes) / 1024.f / reportTime
+                << " | loss: " << loss << "%"
+                << " | memory growth: " << memory / (1024.f * 1024.f) << "MB"
+                << " | programs: " << stats.programsSent << " uploads: " << stats.uploads
+                << " started: " << stats.programsStarted << " rejected: " << stats.programsRejected << std::endl;
+
+            lastBytes = bytes;
+            lastSnapshotBytes = snapshotBytes;
+            lastServerPackets = serverPackets;
+            lastReceived = received;
+            tickTimes.reset();
+            reportTime = 0.f;
+        }
+
+        //run in real time so the network layer behaves as it would for real players
+        auto frameTime = frameClock.restart().asSeconds();
+        if (frameTime < tickRate)
+        {
+            sf::sleep(sf::seconds(tickRate - frameTime));
+            frameClock.restart();
+        }
+    }
+
+    bots.clear();
+    server.stop();
+    return 0;
+}